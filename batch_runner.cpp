@@ -0,0 +1,315 @@
+#include "batch_runner.h"
+#include "metrics.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+#endif
+
+namespace //anonymous
+{
+    const char* const PathSeparators = "/\\";
+
+    std::string FileNameOf(const std::string& path)
+    {
+        const size_t separator = path.find_last_of(PathSeparators);
+        return separator == std::string::npos ? path : path.substr(separator + 1);
+    }
+
+    std::string JoinPath(const std::string& directory, const std::string& name)
+    {
+        if (directory.empty())
+            return name;
+        if (directory.find_last_of(PathSeparators) == directory.size() - 1)
+            return directory + name;
+        return directory + "/" + name;
+    }
+
+    bool IsPattern(const std::string& path)
+    {
+        return path.find_first_of("*?") != std::string::npos;
+    }
+
+#ifdef _WIN32
+
+    std::vector<std::string> FindFiles(const std::string& pattern, const std::string& directory)
+    {
+        std::vector<std::string> files;
+        WIN32_FIND_DATAA data;
+        HANDLE find = FindFirstFileA(pattern.c_str(), &data);
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            if (GetLastError() == ERROR_FILE_NOT_FOUND)
+                return files;
+            throw std::runtime_error("Can't read directory " + directory);
+        }
+        do
+        {
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+                files.push_back(JoinPath(directory, data.cFileName));
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+        return files;
+    }
+
+    std::vector<std::string> ListFiles(const std::string& directoryOrGlob)
+    {
+        if (IsPattern(directoryOrGlob))
+        {
+            const size_t separator = directoryOrGlob.find_last_of(PathSeparators);
+            const std::string directory = separator == std::string::npos ? std::string() : directoryOrGlob.substr(0, separator);
+            return FindFiles(directoryOrGlob, directory);
+        }
+        return FindFiles(JoinPath(directoryOrGlob, "*"), directoryOrGlob);
+    }
+
+#else
+
+    bool IsRegularFile(const std::string& path)
+    {
+        struct stat status;
+        return stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+    }
+
+    std::vector<std::string> ListFiles(const std::string& directoryOrGlob)
+    {
+        std::vector<std::string> files;
+        if (IsPattern(directoryOrGlob))
+        {
+            glob_t matches = {};
+            const int result = glob(directoryOrGlob.c_str(), 0, nullptr, &matches);
+            if (result != 0 && result != GLOB_NOMATCH)
+            {
+                globfree(&matches);
+                throw std::runtime_error("Can't read files " + directoryOrGlob);
+            }
+            for (size_t i = 0; i < matches.gl_pathc; ++i)
+            {
+                if (IsRegularFile(matches.gl_pathv[i]))
+                    files.push_back(matches.gl_pathv[i]);
+            }
+            globfree(&matches);
+            return files;
+        }
+
+        DIR* directory = opendir(directoryOrGlob.c_str());
+        if (directory == nullptr)
+            throw std::runtime_error("Can't read directory " + directoryOrGlob);
+        while (const dirent* entry = readdir(directory))
+        {
+            const std::string path = JoinPath(directoryOrGlob, entry->d_name);
+            if (IsRegularFile(path))
+                files.push_back(path);
+        }
+        closedir(directory);
+        return files;
+    }
+
+#endif
+
+    void ProcessFile(BatchFileResult& result, InputParser& parser, BowlingMachine& machine,
+        const RendererFactory& rendererFactory)
+    {
+        PlayersHits playersHits;
+        {
+            StageTimer timer(MetricStage::Parse);
+            playersHits = parser.ParseFile(result.inputFile);
+        }
+        PlayersStatus statuses;
+        PlayersTable table;
+        {
+            StageTimer timer(MetricStage::Score);
+            table = machine.TryCalcPlayersTable(playersHits, statuses);
+        }
+        size_t validCount = 0;
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            if (!statuses[i].Ok())
+                continue;
+            if (validCount != i)
+                table[validCount] = std::move(table[i]);
+            ++validCount;
+        }
+        table.resize(validCount);
+        result.players = validCount;
+        result.skipped = playersHits.size() - validCount;
+        StageTimer timer(MetricStage::Render);
+        rendererFactory(result.outputFile)->Render(table);
+    }
+
+}   //namespace anonymous
+
+std::vector<std::string> listInputFiles(const std::string& directoryOrGlob)
+{
+    std::vector<std::string> files = ListFiles(directoryOrGlob);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::vector<BatchFileResult> runBatch(const std::vector<std::string>& inputFiles, const std::string& outputDirectory,
+    const std::string& outputSuffix, InputParser& parser, BowlingMachine& machine,
+    const RendererFactory& rendererFactory, ThreadPool& pool)
+{
+    std::vector<BatchFileResult> results(inputFiles.size());
+    std::unordered_map<std::string, size_t> outputOwners;
+    for (size_t i = 0; i < inputFiles.size(); ++i)
+    {
+        results[i].inputFile = inputFiles[i];
+        results[i].outputFile = JoinPath(outputDirectory, FileNameOf(inputFiles[i]) + outputSuffix);
+        results[i].players = 0;
+        results[i].skipped = 0;
+        //inputs of the same name from different directories would overwrite output of each other
+        const auto owner = outputOwners.emplace(results[i].outputFile, i);
+        if (!owner.second)
+            results[i].error = "Output " + results[i].outputFile + " is already written for " + inputFiles[owner.first->second];
+    }
+
+    //files are small, so every file is a task and idle threads steal the rest
+    pool.ParallelFor(results.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (!results[i].error.empty())
+                continue;
+            try
+            {
+                ProcessFile(results[i], parser, machine, rendererFactory);
+            }
+            catch (const std::exception& e)
+            {
+                results[i].error = e.what();
+            }
+        }
+    });
+    return results;
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace //anonymous
+{
+    void MakeTestDirectory(const std::string& path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+    void RemoveTestDirectory(const std::string& path)
+    {
+        for (const std::string& file : listInputFiles(path))
+            std::remove(file.c_str());
+#ifdef _WIN32
+        _rmdir(path.c_str());
+#else
+        rmdir(path.c_str());
+#endif
+    }
+
+    void WriteFile(const std::string& path, const std::string& content)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+
+    std::string ReadFile(const std::string& path)
+    {
+        std::ifstream input(path, std::ios::binary);
+        std::stringstream content;
+        content << input.rdbuf();
+        return content.str();
+    }
+}   //namespace anonymous
+
+///Every file gets its output or its error, failure of one file doesn't stop the others
+TEST(batchRunner, filesAreProcessedIndependently)
+{
+    const std::string inputDirectory = "batch_runner_test_input";
+    const std::string outputDirectory = "batch_runner_test_output";
+    MakeTestDirectory(inputDirectory);
+    MakeTestDirectory(outputDirectory);
+    const std::string perfect = "Dude: 10 10 10 10 10 10 10 10 10 10 10 10\n";
+    const std::string wrong = "Walter: 10 10\n";
+    WriteFile(inputDirectory + "/game1.txt", perfect);
+    WriteFile(inputDirectory + "/game2.txt", perfect + wrong);
+    WriteFile(inputDirectory + "/game3.txt", "Donny: 1 x\n");
+    WriteFile(inputDirectory + "/notes.log", perfect);
+
+    EXPECT_EQ(listInputFiles(inputDirectory).size(), 4u);
+    const std::vector<std::string> inputs = listInputFiles(inputDirectory + "/game*.txt");
+    ASSERT_EQ(inputs.size(), 3u);
+    EXPECT_EQ(inputs[0], inputDirectory + "/game1.txt");
+
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    ThreadPool pool(3);
+    const std::vector<BatchFileResult> results = runBatch(inputs, outputDirectory, ".jsonl", *parser, *machine,
+        [](const std::string& outputFile) -> RendererPtr { return getJsonLinesRenderer(outputFile); }, pool);
+
+    ASSERT_EQ(results.size(), 3u);
+    std::string expected;
+    appendJsonLine(expected, machine->CalcPlayersTable({ PlayerHits{ "Dude", Hits(12, 10) } })[0]);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(results[i].error, "");
+        EXPECT_EQ(results[i].players, 1u);
+        EXPECT_EQ(ReadFile(results[i].outputFile), expected);
+    }
+    EXPECT_EQ(results[1].outputFile, outputDirectory + "/game2.txt.jsonl");
+    EXPECT_EQ(results[0].skipped, 0u);
+    EXPECT_EQ(results[1].skipped, 1u);
+    EXPECT_NE(results[2].error, "");
+
+    RemoveTestDirectory(inputDirectory);
+    RemoveTestDirectory(outputDirectory);
+}
+
+///Inputs of the same name from different directories don't overwrite output of each other
+TEST(batchRunner, sameFileNames)
+{
+    const std::string firstDirectory = "batch_runner_test_first";
+    const std::string secondDirectory = "batch_runner_test_second";
+    const std::string outputDirectory = "batch_runner_test_output";
+    MakeTestDirectory(firstDirectory);
+    MakeTestDirectory(secondDirectory);
+    MakeTestDirectory(outputDirectory);
+    WriteFile(firstDirectory + "/game.txt", "Dude: 10 10 10 10 10 10 10 10 10 10 10 10\n");
+    WriteFile(secondDirectory + "/game.txt", "Walter: 1 0 1 0 1 0 1 0 1 0 1 0 1 0 1 0 1 0 1 0\n");
+
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    ThreadPool pool(2);
+    const std::vector<BatchFileResult> results = runBatch({ firstDirectory + "/game.txt", secondDirectory + "/game.txt" },
+        outputDirectory, ".jsonl", *parser, *machine,
+        [](const std::string& outputFile) -> RendererPtr { return getJsonLinesRenderer(outputFile); }, pool);
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].error, "");
+    EXPECT_NE(results[1].error, "");
+    std::string expected;
+    appendJsonLine(expected, machine->CalcPlayersTable({ PlayerHits{ "Dude", Hits(12, 10) } })[0]);
+    EXPECT_EQ(ReadFile(results[0].outputFile), expected);
+
+    RemoveTestDirectory(firstDirectory);
+    RemoveTestDirectory(secondDirectory);
+    RemoveTestDirectory(outputDirectory);
+}
+
+#endif
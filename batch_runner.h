@@ -0,0 +1,38 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "bowling_machine.h"
+#include "input_parser.h"
+#include "result_renderer.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+///Regular files of directory, or files matching glob pattern with '*' and '?' in the file name.
+///Sorted by name, throws std::runtime_error if directory can't be read
+std::vector<std::string> listInputFiles(const std::string& directoryOrGlob);
+
+///Creates renderer writing into outputFile
+typedef std::function<RendererPtr(const std::string& outputFile)> RendererFactory;
+
+struct BatchFileResult
+{
+    std::string inputFile;
+    std::string outputFile;
+    size_t players;         ///rendered players
+    size_t skipped;         ///wrong players which are not rendered
+    std::string error;      ///empty if the file is done
+};
+
+///Parse, score and render every input file on pool threads, so many files are read and scored
+///at once. Output of input file is outputSuffix appended to its name in outputDirectory, input
+///whose output name is taken by an earlier input of the same name fails. Parser, machine and
+///rendererFactory are shared by all threads. Failure of a file is reported in its result and
+///doesn't stop the others. Results are in inputFiles order
+std::vector<BatchFileResult> runBatch(const std::vector<std::string>& inputFiles, const std::string& outputDirectory,
+    const std::string& outputSuffix, InputParser& parser, BowlingMachine& machine,
+    const RendererFactory& rendererFactory, ThreadPool& pool);
+
+#endif //BATCH_RUNNER_H
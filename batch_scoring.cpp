@@ -0,0 +1,75 @@
+#include "batch_scoring.h"
+
+namespace //anonymous
+{
+    ///Lanes are computed as signed 16-bit values: hits are clamped to 0xff, so nothing overflows,
+    ///and signed compares map to single SIMD instructions unlike unsigned ones
+    typedef int16_t Lane;
+
+    inline Lane Mask(bool condition)
+    {
+        return -static_cast<Lane>(condition);
+    }
+
+    const Lane AllPins = static_cast<Lane>(AllPinsDown);
+
+}   //namespace anonymous
+
+void scoreBatch(const HitsBatch& hits, FramesBatch& frames)
+{
+    Lane position[BatchWidth] = {};     //index of the first hit of current frame
+    Lane total[BatchWidth] = {};
+    Lane valid[BatchWidth];
+    Lane strike[BatchWidth];
+    Lane spare[BatchWidth];
+    Lane third[BatchWidth];
+    for (size_t g = 0; g < BatchWidth; ++g)
+        valid[g] = Mask(true);
+
+    for (size_t f = 0; f < FramesPerGame; ++f)
+    {
+        //frame f starts at hit f if all previous frames are strikes and at 2f if there are none,
+        //so pick hits of every lane from these rows by position mask instead of gather
+        Lane first[BatchWidth] = {};
+        Lane second[BatchWidth] = {};
+        for (size_t g = 0; g < BatchWidth; ++g)
+            third[g] = 0;
+        for (size_t i = f; i <= 2 * f; ++i)
+        {
+            for (size_t g = 0; g < BatchWidth; ++g)
+            {
+                const Lane atRow = Mask(position[g] == static_cast<Lane>(i));
+                first[g] |= atRow & static_cast<Lane>(hits.hits[i][g]);
+                second[g] |= atRow & static_cast<Lane>(hits.hits[i + 1][g]);
+                third[g] |= atRow & static_cast<Lane>(hits.hits[i + 2][g]);
+            }
+        }
+
+        for (size_t g = 0; g < BatchWidth; ++g)
+        {
+            const Lane sum = first[g] + second[g];
+            strike[g] = Mask(first[g] == AllPins);
+            spare[g] = ~strike[g] & Mask(sum == AllPins);
+            const Lane result = sum + ((strike[g] | spare[g]) & third[g]);
+
+            valid[g] &= Mask(first[g] <= AllPins) & Mask(second[g] <= AllPins)
+                & Mask(third[g] <= AllPins) & (strike[g] | Mask(sum <= AllPins));
+            frames.firstHit[f][g] = first[g];
+            frames.secondHit[f][g] = second[g];
+            frames.strike[f][g] = strike[g];
+            frames.spare[f][g] = spare[g];
+            frames.result[f][g] = result;
+            total[g] += result;
+            position[g] += 2 + strike[g];
+        }
+    }
+
+    //10th frame owns its bonus hits: two after strike, one after spare
+    for (size_t g = 0; g < BatchWidth; ++g)
+    {
+        const Lane used = position[g] + (strike[g] & 2) + (spare[g] & 1);
+        frames.valid[g] = valid[g] & Mask(used == static_cast<Lane>(hits.hitCount[g]));
+        frames.bonusHit[g] = (strike[g] | spare[g]) & third[g];
+        frames.total[g] = total[g];
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef BATCH_SCORING_H
+#define BATCH_SCORING_H
+
+#include "const.h"
+#include <cstddef>
+#include <cstdint>
+
+///Count of games scored together, one game per SIMD lane
+const size_t BatchWidth = 16;
+
+///Hits of a game without errors: two per frame and a bonus one in 10th frame
+const size_t MaxHitsPerGame = 2 * FramesPerGame + 1;
+
+///Hits of BatchWidth games in structure-of-arrays layout, hits[i][g] is i-th hit of game g.
+///Rows past hitCount must be zero, two extra rows let bonus hits be read past the last frame
+struct HitsBatch
+{
+    uint16_t hits[MaxHitsPerGame + 2][BatchWidth];
+    uint16_t hitCount[BatchWidth];
+};
+
+///Frame results of BatchWidth games in structure-of-arrays layout.
+///Flags are lane masks: 0xffff for true, 0 for false
+struct FramesBatch
+{
+    uint16_t firstHit[FramesPerGame][BatchWidth];
+    uint16_t secondHit[FramesPerGame][BatchWidth];  ///for strike it is the first bonus hit
+    uint16_t bonusHit[BatchWidth];                  ///last hit of 10th frame after strike or spare
+    uint16_t strike[FramesPerGame][BatchWidth];
+    uint16_t spare[FramesPerGame][BatchWidth];
+    uint16_t result[FramesPerGame][BatchWidth];
+    uint16_t total[BatchWidth];
+    uint16_t valid[BatchWidth];     ///game is complete and correct, otherwise it must be scored one by one
+};
+
+///Score BatchWidth games at once. All lanes run the same instructions, strikes and spares
+///are selected by masks instead of branches, so the loops vectorize across games
+void scoreBatch(const HitsBatch& hits, FramesBatch& frames);
+
+#endif //BATCH_SCORING_H
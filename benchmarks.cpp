@@ -0,0 +1,313 @@
+#include "input_parser.h"
+#include "bowling_machine.h"
+#include "game_generator.h"
+#include "batch_scoring.h"
+#include "score_cache.h"
+#include "ranking.h"
+#include "result_renderer.h"
+#include "thread_pool.h"
+#include "benchmark/benchmark.h"
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+namespace //anonymous
+{
+    ///Text input of playerCount players, every player has rolls of a typical game
+    std::string MakeInput(size_t playerCount, size_t& rollCount)
+    {
+        const char* games[] =
+        {
+            "10 5 5 7 2 6 4 10 0 7 6 4 3 5 7 2 10 10 10",
+            "5 5 7 1 8 2 3 5 8 2 10 0 6 5 5 6 1 0 10 5",
+            "0 0 10 0 7 8 1 7 3 6 1 0 10 6 1 7 0 5 4",
+        };
+        const size_t gameRolls[] = { 19, 20, 19 };
+
+        std::string input;
+        rollCount = 0;
+        for (size_t i = 0; i < playerCount; ++i)
+        {
+            input += "Player" + std::to_string(i) + ": " + games[i % 3] + "\n";
+            rollCount += gameRolls[i % 3];
+        }
+        return input;
+    }
+
+    void ParseInput(benchmark::State& state, InputParser& parser)
+    {
+        size_t rollCount = 0;
+        const std::string input = MakeInput(static_cast<size_t>(state.range(0)), rollCount);
+        for (auto _ : state)
+        {
+            std::istringstream in(input);
+            size_t parsed = 0;
+            parser.ForEachPlayer(in, [&parsed](PlayerHits& player) { parsed += player.hits.size(); });
+            benchmark::DoNotOptimize(parsed);
+        }
+        state.counters["rolls"] = benchmark::Counter(static_cast<double>(rollCount * state.iterations()), benchmark::Counter::kIsRate);
+        state.SetBytesProcessed(static_cast<int64_t>(input.size() * state.iterations()));
+    }
+
+    ///Original getline + stringstream parser
+    void BM_ParseStringStream(benchmark::State& state)
+    {
+        ParseInput(state, *getInputParser());
+    }
+
+    void BM_ParseTokenizer(benchmark::State& state, TokenizerIsa isa)
+    {
+        try
+        {
+            InputParserPtr parser = getMappedInputParser(1, isa);
+            ParseInput(state, *parser);
+        }
+        catch (const std::runtime_error& e)
+        {
+            state.SkipWithError(e.what());
+        }
+    }
+
+    ///Valid games of game generator with default distribution
+    PlayersHits MakeRandomGames(size_t playerCount)
+    {
+        const GeneratorOptions options;
+        PlayersHits players(playerCount);
+        for (size_t i = 0; i < playerCount; ++i)
+            generatePlayer(options, i, players[i]);
+        return players;
+    }
+
+    void ScorePlayers(benchmark::State& state, BowlingMachine& machine)
+    {
+        const PlayersHits players = MakeRandomGames(static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            PlayersTable table = machine.CalcPlayersTable(players);
+            benchmark::DoNotOptimize(table.data());
+        }
+        state.counters["games"] = benchmark::Counter(static_cast<double>(players.size() * state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    void BM_ScoreScalar(benchmark::State& state)
+    {
+        ScorePlayers(state, *getBowlingMachine());
+    }
+
+    void BM_ScoreBatch(benchmark::State& state)
+    {
+        ScorePlayers(state, *getBatchBowlingMachine());
+    }
+
+    ///Every game repeats state.range(1) times, the cache is warm after the first iteration
+    void BM_ScoreCached(benchmark::State& state)
+    {
+        PlayersHits players = MakeRandomGames(static_cast<size_t>(state.range(0) / state.range(1)));
+        players.reserve(static_cast<size_t>(state.range(0)));
+        for (size_t i = players.size(); i < static_cast<size_t>(state.range(0)); ++i)
+            players.push_back(players[i % players.size()]);
+        ScoreCache cache(64 * 1024 * 1024);
+        BowlingMachinePtr machine = getCachingBowlingMachine(cache);
+        for (auto _ : state)
+        {
+            PlayersTable table = machine->CalcPlayersTable(players);
+            benchmark::DoNotOptimize(table.data());
+        }
+        state.counters["games"] = benchmark::Counter(static_cast<double>(players.size() * state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    void BM_ScoreTable(benchmark::State& state)
+    {
+        ScorePlayers(state, *getTableBowlingMachine());
+    }
+
+    ///Only the batch kernel, without building PlayersTable which dominates the engines above
+    void BM_ScoreBatchKernel(benchmark::State& state)
+    {
+        const PlayersHits players = MakeRandomGames(BatchWidth);
+        HitsBatch hits = {};
+        for (size_t g = 0; g < BatchWidth; ++g)
+        {
+            hits.hitCount[g] = static_cast<uint16_t>(players[g].hits.size());
+            for (size_t i = 0; i < players[g].hits.size(); ++i)
+                hits.hits[i][g] = static_cast<uint16_t>(players[g].hits[i]);
+        }
+        FramesBatch frames;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(&hits);
+            scoreBatch(hits, frames);
+            benchmark::DoNotOptimize(frames.total);
+        }
+        state.counters["games"] = benchmark::Counter(static_cast<double>(BatchWidth * state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    ///Whole game fed roll by roll into live scorer
+    void BM_LiveGame(benchmark::State& state)
+    {
+        const PlayersHits players = MakeRandomGames(1000);
+        size_t rollCount = 0;
+        for (auto _ : state)
+        {
+            for (const PlayerHits& player : players)
+            {
+                LiveGamePtr game = getLiveGame(player.playerName);
+                for (unsigned int pins : player.hits)
+                    game->AddRoll(pins);
+                benchmark::DoNotOptimize(game->Table().total);
+                rollCount += player.hits.size();
+            }
+        }
+        state.counters["rolls"] = benchmark::Counter(static_cast<double>(rollCount), benchmark::Counter::kIsRate);
+    }
+
+    ///Games of benchmarks over input sizes
+    enum GameMix
+    {
+        AllStrikes,
+        AllMisses,
+        RandomMix,
+    };
+
+    PlayersHits MakeGames(size_t playerCount, GameMix mix)
+    {
+        if (mix == RandomMix)
+            return MakeRandomGames(playerCount);
+        PlayersHits players(playerCount);
+        for (size_t i = 0; i < playerCount; ++i)
+        {
+            players[i].playerName = "Player" + std::to_string(i);
+            players[i].hits = mix == AllStrikes ? Hits(12, 10) : Hits(20, 0);
+        }
+        return players;
+    }
+
+    std::string MakeText(const PlayersHits& players)
+    {
+        std::string text;
+        for (const PlayerHits& player : players)
+        {
+            text += player.playerName;
+            text += ':';
+            for (unsigned int hit : player.hits)
+            {
+                text += ' ';
+                text += std::to_string(hit);
+            }
+            text += '\n';
+        }
+        return text;
+    }
+
+    ///Discards everything, so rendering is measured without I/O
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override
+        {
+            return c;
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize count) override
+        {
+            return count;
+        }
+    };
+
+    void SetPlayersRate(benchmark::State& state, size_t playerCount)
+    {
+        state.counters["players"] = benchmark::Counter(static_cast<double>(playerCount * state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    void BM_Parse(benchmark::State& state, GameMix mix)
+    {
+        const size_t playerCount = static_cast<size_t>(state.range(0));
+        const std::string input = MakeText(MakeGames(playerCount, mix));
+        InputParserPtr parser = getMappedInputParser(1);
+        for (auto _ : state)
+        {
+            std::istringstream in(input);
+            PlayersHits players = parser->Parse(in);
+            benchmark::DoNotOptimize(players.data());
+        }
+        SetPlayersRate(state, playerCount);
+        state.SetBytesProcessed(static_cast<int64_t>(input.size() * state.iterations()));
+    }
+
+    void BM_CalcPlayersTable(benchmark::State& state, GameMix mix)
+    {
+        const size_t playerCount = static_cast<size_t>(state.range(0));
+        const PlayersHits players = MakeGames(playerCount, mix);
+        BowlingMachinePtr machine = getBowlingMachine();
+        for (auto _ : state)
+        {
+            PlayersTable table = machine->CalcPlayersTable(players);
+            benchmark::DoNotOptimize(table.data());
+        }
+        SetPlayersRate(state, playerCount);
+    }
+
+    void BM_RenderTable(benchmark::State& state, GameMix mix)
+    {
+        const size_t playerCount = static_cast<size_t>(state.range(0));
+        const PlayersTable table = getBowlingMachine()->CalcPlayersTable(MakeGames(playerCount, mix));
+        NullBuffer buffer;
+        std::ostream out(&buffer);
+        RendererPtr renderer = getStreamRenderer(out);
+        for (auto _ : state)
+            renderer->Render(table);
+        SetPlayersRate(state, playerCount);
+    }
+
+    ///Top 100 by bounded heap against sorting all players, state.range(1) threads
+    void BM_TopPlayers(benchmark::State& state)
+    {
+        const PlayersTable table = getBowlingMachine()->CalcPlayersTable(MakeRandomGames(static_cast<size_t>(state.range(0))));
+        ThreadPool pool(static_cast<size_t>(state.range(1)));
+        for (auto _ : state)
+        {
+            Ranking top = topPlayers(table, 100, RankStyle::Competition, pool);
+            benchmark::DoNotOptimize(top.data());
+        }
+        state.counters["players"] = benchmark::Counter(static_cast<double>(table.size() * state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    void BM_RankAllPlayers(benchmark::State& state)
+    {
+        const PlayersTable table = getBowlingMachine()->CalcPlayersTable(MakeRandomGames(static_cast<size_t>(state.range(0))));
+        for (auto _ : state)
+        {
+            Ranking ranking = rankPlayers(table, RankStyle::Competition);
+            benchmark::DoNotOptimize(ranking.data());
+        }
+        state.counters["players"] = benchmark::Counter(static_cast<double>(table.size() * state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+}   //namespace anonymous
+
+BENCHMARK(BM_ParseStringStream)->Arg(100000);
+BENCHMARK_CAPTURE(BM_ParseTokenizer, scalar, TokenizerIsa::Scalar)->Arg(100000);
+BENCHMARK_CAPTURE(BM_ParseTokenizer, sse2, TokenizerIsa::Sse2)->Arg(100000);
+BENCHMARK_CAPTURE(BM_ParseTokenizer, avx2, TokenizerIsa::Avx2)->Arg(100000);
+
+BENCHMARK(BM_ScoreScalar)->Arg(100000);
+BENCHMARK(BM_ScoreBatch)->Arg(100000);
+BENCHMARK(BM_ScoreTable)->Arg(100000);
+BENCHMARK(BM_ScoreCached)->Args({ 100000, 10 });
+BENCHMARK(BM_ScoreBatchKernel);
+BENCHMARK(BM_LiveGame);
+
+BENCHMARK(BM_TopPlayers)->Args({ 1000000, 1 })->Args({ 1000000, 4 });
+BENCHMARK(BM_RankAllPlayers)->Arg(1000000);
+
+//stages over input sizes and game mixes, 10 to 10M players
+#define BOWLING_STAGE_BENCHMARK(stage) \
+    BENCHMARK_CAPTURE(stage, strikes, AllStrikes)->RangeMultiplier(10)->Range(10, 10000000)->Unit(benchmark::kMicrosecond); \
+    BENCHMARK_CAPTURE(stage, misses, AllMisses)->RangeMultiplier(10)->Range(10, 10000000)->Unit(benchmark::kMicrosecond); \
+    BENCHMARK_CAPTURE(stage, random, RandomMix)->RangeMultiplier(10)->Range(10, 10000000)->Unit(benchmark::kMicrosecond)
+
+BOWLING_STAGE_BENCHMARK(BM_Parse);
+BOWLING_STAGE_BENCHMARK(BM_CalcPlayersTable);
+BOWLING_STAGE_BENCHMARK(BM_RenderTable);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,308 @@
+#include "binary_hits.h"
+#include "metrics.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace //anonymous
+{
+    const char Magic[4] = { 'B', 'W', 'L', 'H' };
+    const uint32_t Version = 1;
+    const size_t HeaderSize = 4 + 4 + 8 + 8;
+    const unsigned int MaxPackedHit = 15;
+
+    uint64_t ReadLE(const unsigned char* data, size_t size)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        return value;
+    }
+
+    void AppendLE(std::vector<char>& out, uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+
+    void WriteLE(std::ostream& out, uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+
+    void ThrowCorrupted()
+    {
+        throw std::runtime_error("Binary hits file is corrupted");
+    }
+
+    ///Unpack hitCount 4-bit hits from packed bytes
+    void UnpackHits(const unsigned char* packed, size_t hitCount, Hits& hits)
+    {
+        hits.resize(hitCount);
+        for (size_t i = 0; i + 1 < hitCount; i += 2)
+        {
+            hits[i] = packed[i / 2] & 0x0f;
+            hits[i + 1] = packed[i / 2] >> 4;
+        }
+        if (hitCount % 2 != 0)
+            hits[hitCount - 1] = packed[hitCount / 2] & 0x0f;
+    }
+
+    ///Decode record at [pos, end), returns position after record
+    const unsigned char* DecodeRecord(const unsigned char* pos, const unsigned char* end, PlayerHits& player)
+    {
+        if (end - pos < 2)
+            ThrowCorrupted();
+        const size_t nameLength = static_cast<size_t>(ReadLE(pos, 2));
+        pos += 2;
+        if (static_cast<size_t>(end - pos) < nameLength + 2)
+            ThrowCorrupted();
+        player.playerName.assign(reinterpret_cast<const char*>(pos), nameLength);
+        pos += nameLength;
+        const size_t hitCount = static_cast<size_t>(ReadLE(pos, 2));
+        pos += 2;
+        if (static_cast<size_t>(end - pos) < (hitCount + 1) / 2)
+            ThrowCorrupted();
+        UnpackHits(pos, hitCount, player.hits);
+        return pos + (hitCount + 1) / 2;
+    }
+
+    ///Check header and return player count
+    size_t DecodeHeader(const unsigned char* header)
+    {
+        if (!std::equal(Magic, Magic + sizeof(Magic), reinterpret_cast<const char*>(header)))
+            throw std::runtime_error("Not a binary hits file");
+        if (ReadLE(header + 4, 4) != Version)
+            throw std::runtime_error("Unsupported binary hits file version");
+        return static_cast<size_t>(ReadLE(header + 8, 8));
+    }
+
+    class BinaryInputParserImpl : public InputParser
+    {
+    public:
+        void ForEachPlayer(std::istream& input, const PlayerHandler& handler) override
+        {
+            unsigned char header[HeaderSize];
+            if (!input.read(reinterpret_cast<char*>(header), sizeof(header)))
+                throw std::runtime_error("Not a binary hits file");
+            const size_t playerCount = DecodeHeader(header);
+
+            PlayerHits player;
+            std::vector<unsigned char> packed;
+            for (size_t i = 0; i < playerCount; ++i)
+            {
+                unsigned char length[2];
+                if (!input.read(reinterpret_cast<char*>(length), sizeof(length)))
+                    ThrowCorrupted();
+                player.playerName.resize(static_cast<size_t>(ReadLE(length, 2)));
+                if (!player.playerName.empty() && !input.read(&player.playerName[0], player.playerName.size()))
+                    ThrowCorrupted();
+                if (!input.read(reinterpret_cast<char*>(length), sizeof(length)))
+                    ThrowCorrupted();
+                const size_t hitCount = static_cast<size_t>(ReadLE(length, 2));
+                packed.resize((hitCount + 1) / 2);
+                if (!packed.empty() && !input.read(reinterpret_cast<char*>(packed.data()), packed.size()))
+                    ThrowCorrupted();
+                UnpackHits(packed.data(), hitCount, player.hits);
+                handler(player);
+            }
+        }
+
+        void ForEachPlayerInFile(const std::string& filename, const PlayerHandler& handler) override
+        {
+            MappedFile file(filename);
+            const unsigned char* pos = reinterpret_cast<const unsigned char*>(file.Data());
+            const unsigned char* end = pos + file.Size();
+            if (file.Size() < HeaderSize)
+                throw std::runtime_error("Not a binary hits file");
+            const size_t playerCount = DecodeHeader(pos);
+            pos += HeaderSize;
+
+            PlayerHits player;
+            for (size_t i = 0; i < playerCount; ++i)
+            {
+                pos = DecodeRecord(pos, end, player);
+                handler(player);
+            }
+            addMetric(MetricCounter::BytesParsed, file.Size());
+            addMetric(MetricCounter::LinesParsed, playerCount);
+        }
+    };
+
+    ///Write player in text input format
+    void WriteTextPlayer(std::ostream& out, const PlayerHits& player)
+    {
+        out << player.playerName << ':';
+        for (unsigned int hit : player.hits)
+            out << ' ' << hit;
+        out << '\n';
+    }
+
+}   //namespace anonymous
+
+BinaryHitsWriter::BinaryHitsWriter(std::ostream& out)
+    : m_out(out)
+    , m_position(HeaderSize)
+{
+    //header is patched by Finish
+    m_out.write(Magic, sizeof(Magic));
+    WriteLE(m_out, Version, 4);
+    WriteLE(m_out, 0, 8);
+    WriteLE(m_out, 0, 8);
+}
+
+void BinaryHitsWriter::Write(const PlayerHits& player)
+{
+    if (player.playerName.size() > 0xffff)
+        throw std::runtime_error("Player name is too long for binary format: " + player.playerName);
+    if (player.hits.size() > 0xffff)
+        throw std::runtime_error("Too many hits for binary format: " + player.playerName);
+
+    m_record.clear();
+    AppendLE(m_record, player.playerName.size(), 2);
+    m_record.insert(m_record.end(), player.playerName.begin(), player.playerName.end());
+    AppendLE(m_record, player.hits.size(), 2);
+    for (size_t i = 0; i < player.hits.size(); i += 2)
+    {
+        const unsigned int low = player.hits[i];
+        const unsigned int high = i + 1 < player.hits.size() ? player.hits[i + 1] : 0;
+        if (low > MaxPackedHit || high > MaxPackedHit)
+            throw std::runtime_error("Hit value doesn't fit into binary format: " + player.playerName);
+        m_record.push_back(static_cast<char>(low | (high << 4)));
+    }
+
+    m_out.write(m_record.data(), m_record.size());
+    m_offsets.push_back(m_position);
+    m_position += m_record.size();
+}
+
+void BinaryHitsWriter::Finish()
+{
+    for (uint64_t offset : m_offsets)
+        WriteLE(m_out, offset, 8);
+    m_out.seekp(sizeof(Magic) + 4);
+    WriteLE(m_out, m_offsets.size(), 8);
+    WriteLE(m_out, m_position, 8);
+    m_out.seekp(0, std::ios::end);
+    if (!m_out)
+        throw std::runtime_error("Can't write binary hits");
+}
+
+BinaryHitsFile::BinaryHitsFile(const std::string& filename)
+    : m_file(filename)
+    , m_playerCount(0)
+    , m_index(nullptr)
+{
+    if (m_file.Size() < HeaderSize)
+        throw std::runtime_error("Not a binary hits file: " + filename);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(m_file.Data());
+    m_playerCount = DecodeHeader(data);
+    const uint64_t indexOffset = ReadLE(data + 16, 8);
+    if (indexOffset > m_file.Size() || (m_file.Size() - indexOffset) / 8 < m_playerCount)
+        ThrowCorrupted();
+    m_index = data + indexOffset;
+}
+
+void BinaryHitsFile::Read(size_t index, PlayerHits& player) const
+{
+    if (index >= m_playerCount)
+        throw std::out_of_range("Player index is out of range");
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(m_file.Data());
+    const uint64_t offset = ReadLE(m_index + 8 * index, 8);
+    if (offset < HeaderSize || offset >= static_cast<uint64_t>(m_index - data))
+        ThrowCorrupted();
+    DecodeRecord(data + offset, m_index, player);
+}
+
+bool isBinaryHitsFile(const std::string& filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(Magic)];
+    return input.read(magic, sizeof(magic)) && std::equal(Magic, Magic + sizeof(Magic), magic);
+}
+
+InputParserPtr getBinaryInputParser()
+{
+    return std::make_unique<BinaryInputParserImpl>();
+}
+
+void convertTextToBinary(const std::string& textFileName, const std::string& binaryFileName)
+{
+    std::ofstream out(binaryFileName, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Can't open file " + binaryFileName);
+    BinaryHitsWriter writer(out);
+    getMappedInputParser()->ForEachPlayerInFile(textFileName, [&writer](PlayerHits& player) { writer.Write(player); });
+    writer.Finish();
+}
+
+void convertBinaryToText(const std::string& binaryFileName, const std::string& textFileName)
+{
+    std::ofstream out(textFileName, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Can't open file " + textFileName);
+    getBinaryInputParser()->ForEachPlayerInFile(binaryFileName, [&out](PlayerHits& player) { WriteTextPlayer(out, player); });
+    if (!out)
+        throw std::runtime_error("Can't write file " + textFileName);
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <sstream>
+
+///Players written into binary format are read back by stream parser, file parser and by index
+TEST(binaryHits, roundTrip)
+{
+    const PlayersHits players =
+    {
+        { "Lebowsky", { 10, 5, 5, 7, 2, 6, 4, 10, 0, 7, 6, 4, 3, 5, 7, 2, 10, 10, 10 } },
+        { "Sobchak", { 5, 5, 7, 1, 8, 2, 3, 5, 8, 2, 10, 0, 6, 5, 5, 6, 1, 0, 10, 5 } },
+        { "", {} },
+    };
+
+    const std::string filename = "binary_hits_test.tmp";
+    {
+        std::ofstream out(filename, std::ios::binary);
+        BinaryHitsWriter writer(out);
+        for (const PlayerHits& player : players)
+            writer.Write(player);
+        writer.Finish();
+    }
+    ASSERT_TRUE(isBinaryHitsFile(filename));
+
+    std::ifstream input(filename, std::ios::binary);
+    const PlayersHits fromStream = getBinaryInputParser()->Parse(input);
+    input.close();
+    const PlayersHits fromFile = getBinaryInputParser()->ParseFile(filename);
+    ASSERT_EQ(fromStream.size(), players.size());
+    ASSERT_EQ(fromFile.size(), players.size());
+    for (size_t i = 0; i < players.size(); ++i)
+    {
+        EXPECT_EQ(fromStream[i].playerName, players[i].playerName);
+        EXPECT_EQ(fromStream[i].hits, players[i].hits);
+        EXPECT_EQ(fromFile[i].playerName, players[i].playerName);
+        EXPECT_EQ(fromFile[i].hits, players[i].hits);
+    }
+
+    {
+        BinaryHitsFile file(filename);
+        ASSERT_EQ(file.Size(), players.size());
+        PlayerHits player;
+        file.Read(1, player);
+        EXPECT_EQ(player.playerName, players[1].playerName);
+        EXPECT_EQ(player.hits, players[1].hits);
+    }
+    std::remove(filename.c_str());
+}
+
+///Hits which don't fit into 4 bits are rejected
+TEST(binaryHits, hitTooBig)
+{
+    std::stringstream out;
+    BinaryHitsWriter writer(out);
+    EXPECT_THROW(writer.Write({ "Donny", { 1, 16 } }), std::runtime_error);
+}
+
+#endif
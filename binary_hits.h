@@ -0,0 +1,64 @@
+#ifndef BINARY_HITS_H
+#define BINARY_HITS_H
+
+#include "input_parser.h"
+#include "mapped_file.h"
+#include "types.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+///Compact binary format of players hits, all numbers are little-endian:
+///  header:  char magic[4] "BWLH", uint32 version, uint64 player count, uint64 index offset
+///  records: uint16 name length, name, uint16 hit count, hits packed two per byte
+///           (4 bits each, low nibble first)
+///  index:   uint64 offset of every record from file start
+
+///Writes players into binary format, output stream must be seekable to patch header at the end
+class BinaryHitsWriter
+{
+public:
+    explicit BinaryHitsWriter(std::ostream& out);
+
+    ///Throws std::runtime_error if hit value doesn't fit into 4 bits or name is too long
+    void Write(const PlayerHits& player);
+    ///Write index and player count, must be called after the last player
+    void Finish();
+
+private:
+    std::ostream& m_out;
+    std::vector<uint64_t> m_offsets;
+    uint64_t m_position;
+    std::vector<char> m_record;
+};
+
+///Random access to players of binary file without reading whole file
+class BinaryHitsFile
+{
+public:
+    ///Throws std::runtime_error if file can't be mapped or isn't binary hits file
+    explicit BinaryHitsFile(const std::string& filename);
+
+    size_t Size() const { return m_playerCount; }
+    ///Read player by index in file order, throws std::runtime_error if record is corrupted
+    void Read(size_t index, PlayerHits& player) const;
+
+private:
+    MappedFile m_file;
+    size_t m_playerCount;
+    const unsigned char* m_index;
+};
+
+///Check if file starts with binary hits header
+bool isBinaryHitsFile(const std::string& filename);
+
+///Parser of binary format, throws std::runtime_error on corrupted input
+InputParserPtr getBinaryInputParser();
+
+///Convert text input file into binary format
+void convertTextToBinary(const std::string& textFileName, const std::string& binaryFileName);
+///Convert binary file back into text input format
+void convertBinaryToText(const std::string& binaryFileName, const std::string& textFileName);
+
+#endif //BINARY_HITS_H
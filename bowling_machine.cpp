@@ -1,55 +1,81 @@
 #include "bowling_machine.h"
+#include "batch_scoring.h"
+#include "metrics.h"
+#include "scoring_fsm.h"
+#include "rules.h"
+#include "score_cache.h"
 #include "const.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 
 namespace //anonymous
 {
-    class BowlingMachineImpl : public BowlingMachine
+    char MakeChar(unsigned int number, unsigned int allPins = AllPinsDown)
     {
-    private:
-        char MakeChar(unsigned int number)
-        {
-            if (number == 0)
-                return MissSign;
-            if (number == 10)
-                return StrikeSign;
-            return number + '0';
-        }
+        if (number == 0)
+            return MissSign;
+        if (number == allPins)
+            return StrikeSign;
+        return number + '0';
+    }
+
+    ///Scalar machine for rules policy of rules.h
+    template <class Rules>
+    class RulesBowlingMachineImpl : public BowlingMachine
+    {
+        static_assert(Rules::FramesPerGame == FramesPerGame, "machines give PlayersTable with FramesPerGame frames");
+        static_assert(Rules::BallsPerFrame <= MaxHitsPerFrame && 1 + Rules::StrikeBonusHits <= MaxHitsPerFrame
+            && 2 + Rules::SpareBonusHits <= MaxHitsPerFrame, "hits of last frame must fit into FrameHits");
 
 #ifndef UNITTEST
-    private:
+    protected:
 #else
     public:
 #endif
-        PlayerTable CalcPlayerTable(const PlayerHits& hits)
+        ///Score player into result without exceptions, on error result has frames before the wrong one
+        static PlayerStatus CalcPlayerTable(const PlayerHits& hits, PlayerTable& result)
         {
-            PlayerTable result;
+            return CalcPlayerTable(hits, result, std::is_same<Rules, TenPinRules>());
+        }
+
+    private:
+        ///Ten-pin loop knows the frame has at most two balls, so it decides strike and spare by
+        ///ball number without the bonus lookup of other rules. Every engine falls back to it
+        static PlayerStatus CalcPlayerTable(const PlayerHits& hits, PlayerTable& result, std::true_type /*tenPin*/)
+        {
+            result = PlayerTable();
             result.playerName = hits.playerName;
 
             size_t frameNumber = 1;
             Frame currentFrame(frameNumber);
-            std::vector<unsigned int> currentResult;
+            size_t frameHitCount = 0;       //hits made in current frame
+            unsigned int firstHit = 0;      //first hit of current frame
             for (size_t i = 0; i < hits.hits.size(); ++i)
             {
+                if (frameNumber > FramesPerGame)
+                    return PlayerStatus(ScoreError::TooManyHits, i);
                 unsigned int hit = hits.hits[i];
-                if (hit > 10)
-                    throw std::runtime_error("Hit value is more then 10");
-                currentResult.push_back(hit);
+                if (hit > AllPinsDown)
+                    return PlayerStatus(ScoreError::HitTooBig, i);
+                if (frameHitCount++ == 0)
+                    firstHit = hit;
                 currentFrame.result += hit;
-                if (currentFrame.result > 10)
-                    throw std::runtime_error("Frame value can be more than 10 only in case of spare or strike");
+                if (currentFrame.result > AllPinsDown)
+                    return PlayerStatus(ScoreError::FrameOverflow, i);
 
                 bool frameOver = false;
-                if (currentResult.size() == 2)
+                if (frameHitCount == 2)
                 {
                     //2 hit per frame if not strike
-                    currentFrame.hit.push_back(MakeChar(currentResult[0]));
+                    currentFrame.hit.push_back(MakeChar(firstHit));
 
                     if (currentFrame.result == AllPinsDown)
                     {
                         //spare
                         currentFrame.hit.push_back(SpareSign);
                         if (hits.hits.size() <= i + 1)
-                            throw std::runtime_error("Not enought hit values");
+                            return PlayerStatus(ScoreError::NotEnoughHits, i);
                         currentFrame.result += hits.hits[i + 1];
                         if (frameNumber == FramesPerGame)   //10-th frame
                         {
@@ -59,7 +85,7 @@ namespace //anonymous
                     }
                     else
                     {
-                        currentFrame.hit.push_back(MakeChar(currentResult[1]));
+                        currentFrame.hit.push_back(MakeChar(hit));
                     }
 
                     frameOver = true;
@@ -69,7 +95,7 @@ namespace //anonymous
                     //strike
                     currentFrame.hit.push_back(StrikeSign);
                     if (hits.hits.size() <= i + 2)
-                        throw std::runtime_error("Not enought hit values");
+                        return PlayerStatus(ScoreError::NotEnoughHits, i);
                     currentFrame.result += hits.hits[i + 1] + hits.hits[i + 2];
                     if (frameNumber == FramesPerGame)   //10th frame
                     {
@@ -86,38 +112,579 @@ namespace //anonymous
                     result.frames[frameNumber - 1] = currentFrame;
                     ++frameNumber;
                     currentFrame = Frame(frameNumber);
-                    currentResult.clear();
+                    frameHitCount = 0;
                 }
             }
 
+            return PlayerStatus();
+        }
+
+        static PlayerStatus CalcPlayerTable(const PlayerHits& hits, PlayerTable& result, std::false_type /*tenPin*/)
+        {
+            result = PlayerTable();
+            result.playerName = hits.playerName;
+
+            size_t frameNumber = 1;
+            Frame currentFrame(frameNumber);
+            size_t frameHitCount = 0;       //hits made in current frame
+            for (size_t i = 0; i < hits.hits.size(); ++i)
+            {
+                if (frameNumber > Rules::FramesPerGame)
+                    return PlayerStatus(ScoreError::TooManyHits, i);
+                unsigned int hit = hits.hits[i];
+                if (hit > Rules::PinsPerFrame)
+                    return PlayerStatus(ScoreError::HitTooBig, i);
+                ++frameHitCount;
+                currentFrame.result += hit;
+                if (currentFrame.result > Rules::PinsPerFrame)
+                    return PlayerStatus(ScoreError::FrameOverflow, i);
+
+                bool frameOver = false;
+                if (currentFrame.result == Rules::PinsPerFrame)
+                {
+                    //strike, spare or all pins down by the last ball without bonus
+                    const size_t bonusHits = rulesBonusHits<Rules>(frameHitCount);
+                    currentFrame.hit.push_back(frameHitCount == 1 ? StrikeSign
+                        : bonusHits != 0 ? SpareSign : MakeChar(hit, Rules::PinsPerFrame));
+                    if (hits.hits.size() <= i + bonusHits)
+                        return PlayerStatus(ScoreError::NotEnoughHits, i);
+                    for (size_t bonus = 1; bonus <= bonusHits; ++bonus)
+                        currentFrame.result += hits.hits[i + bonus];
+                    if (frameNumber == Rules::FramesPerGame)   //bonus hits belong to last frame, so skip them
+                    {
+                        for (size_t bonus = 1; bonus <= bonusHits; ++bonus)
+                            currentFrame.hit.push_back(MakeChar(hits.hits[i + bonus], Rules::PinsPerFrame));
+                        i += bonusHits;
+                    }
+
+                    frameOver = true;
+                }
+                else
+                {
+                    currentFrame.hit.push_back(MakeChar(hit, Rules::PinsPerFrame));
+                    frameOver = frameHitCount == Rules::BallsPerFrame;
+                }
+                if (frameOver)
+                {
+                    result.total += currentFrame.result;
+                    result.frames[frameNumber - 1] = currentFrame;
+                    ++frameNumber;
+                    currentFrame = Frame(frameNumber);
+                    frameHitCount = 0;
+                }
+            }
+
+            return PlayerStatus();
+        }
+
+#ifndef UNITTEST
+    protected:
+#else
+    public:
+#endif
+        ///Score player, throws std::runtime_error on wrong hits
+        PlayerTable CalcPlayerTable(const PlayerHits& hits)
+        {
+            PlayerTable result;
+            const PlayerStatus status = CalcPlayerTable(hits, result);
+            if (!status.Ok())
+                throw std::runtime_error(ErrorMessage(status.error));
             return result;
         }
 
+        std::string ErrorMessage(ScoreError error) const override
+        {
+            return scoreErrorMessage(error, Rules::PinsPerFrame);
+        }
+
+        ///Score players [begin, end) into preallocated result and statuses without exceptions,
+        ///can be called from several threads
+        virtual void CalcPlayersRange(const PlayersHits& players, size_t begin, size_t end, PlayersTable& result, PlayersStatus& statuses)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                statuses[i] = CalcPlayerTable(players[i], result[i]);
+            }
+        }
+
+        ///CalcPlayersRange which adds scored players, their strikes and spares, and errors to metrics
+        ///when they are enabled
+        void MeteredPlayersRange(const PlayersHits& players, size_t begin, size_t end, PlayersTable& result, PlayersStatus& statuses)
+        {
+            CalcPlayersRange(players, begin, end, result, statuses);
+            if (!metricsEnabled())
+                return;
+            uint64_t scored = 0;
+            uint64_t strikes = 0;
+            uint64_t spares = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!statuses[i].Ok())
+                    continue;
+                ++scored;
+                for (const Frame& frame : result[i].frames)
+                {
+                    for (char symbol : frame.hit)
+                    {
+                        strikes += symbol == StrikeSign;
+                        spares += symbol == SpareSign;
+                    }
+                }
+            }
+            addMetric(MetricCounter::PlayersScored, scored);
+            addMetric(MetricCounter::Strikes, strikes);
+            addMetric(MetricCounter::Spares, spares);
+            addMetric(MetricCounter::Errors, end - begin - scored);
+        }
+
     public:
-        PlayersTable CalcPlayersTable(const PlayersHits& players) override
+        PlayersTable TryCalcPlayersTable(const PlayersHits& players, PlayersStatus& statuses) override
         {
-            PlayersTable result;
+            PlayersTable result(players.size());
+            statuses.assign(players.size(), PlayerStatus());
+            MeteredPlayersRange(players, 0, players.size(), result, statuses);
+            return result;
+        }
+    };
+
+    typedef RulesBowlingMachineImpl<TenPinRules> BowlingMachineImpl;
 
-            for (const PlayerHits& player : players)
+    ///Scores games by batches in structure-of-arrays layout, games which batch scoring
+    ///doesn't accept (errors, incomplete games) are scored one by one
+    class BatchBowlingMachineImpl : public BowlingMachineImpl
+    {
+    private:
+        ///Transpose hits of count players starting from first into batch, missing lanes are empty games
+        static void LoadBatch(const PlayersHits& players, size_t first, size_t count, HitsBatch& batch)
+        {
+            for (size_t i = 0; i < MaxHitsPerGame + 2; ++i)
+                std::fill(batch.hits[i], batch.hits[i] + BatchWidth, 0);
+            static const Hits noHits;
+            for (size_t g = 0; g < BatchWidth; ++g)
             {
-                result.push_back(CalcPlayerTable(player));
+                const Hits& hits = g < count ? players[first + g].hits : noHits;
+                //longer games are wrong, the count mismatch sends them to scalar scoring
+                const size_t hitCount = std::min(hits.size(), MaxHitsPerGame + 1);
+                batch.hitCount[g] = static_cast<uint16_t>(hitCount);
+                for (size_t i = 0; i < std::min(hitCount, MaxHitsPerGame); ++i)
+                    batch.hits[i][g] = static_cast<uint16_t>(std::min(hits[i], 0xffu));    //any hit over 10 is wrong
             }
+        }
 
+        static void StoreLane(const FramesBatch& frames, size_t g, PlayerTable& table)
+        {
+            for (size_t f = 0; f < FramesPerGame; ++f)
+            {
+                Frame& frame = table.frames[f];
+                frame = Frame(f + 1);
+                frame.result = frames.result[f][g];
+                const bool lastFrame = f == FramesPerGame - 1;
+                if (frames.strike[f][g])
+                {
+                    frame.hit.push_back(StrikeSign);
+                    if (lastFrame)
+                    {
+                        frame.hit.push_back(MakeChar(frames.secondHit[f][g]));
+                        frame.hit.push_back(MakeChar(frames.bonusHit[g]));
+                    }
+                }
+                else if (frames.spare[f][g])
+                {
+                    frame.hit.push_back(MakeChar(frames.firstHit[f][g]));
+                    frame.hit.push_back(SpareSign);
+                    if (lastFrame)
+                        frame.hit.push_back(MakeChar(frames.bonusHit[g]));
+                }
+                else
+                {
+                    frame.hit.push_back(MakeChar(frames.firstHit[f][g]));
+                    frame.hit.push_back(MakeChar(frames.secondHit[f][g]));
+                }
+            }
+            table.total = frames.total[g];
+        }
+
+    protected:
+        void CalcPlayersRange(const PlayersHits& players, size_t begin, size_t end, PlayersTable& result, PlayersStatus& statuses) override
+        {
+            HitsBatch hits;
+            FramesBatch frames;
+            for (size_t first = begin; first < end; first += BatchWidth)
+            {
+                const size_t count = std::min(BatchWidth, end - first);
+                LoadBatch(players, first, count, hits);
+                scoreBatch(hits, frames);
+                for (size_t g = 0; g < count; ++g)
+                {
+                    PlayerTable& table = result[first + g];
+                    if (frames.valid[g])
+                    {
+                        table.playerName = players[first + g].playerName;
+                        StoreLane(frames, g, table);
+                    }
+                    else
+                    {
+                        statuses[first + g] = CalcPlayerTable(players[first + g], table);
+                    }
+                }
+            }
+        }
+    };
+
+    ///Scores games by lookups into compile-time transition tables of scoring_fsm.h,
+    ///wrong and incomplete games are scored by the base machine to get the same errors
+    class TableBowlingMachineImpl : public BowlingMachineImpl
+    {
+    private:
+        ///Returns false if the game isn't complete and correct
+        static bool CalcTablePlayer(const PlayerHits& hits, PlayerTable& table)
+        {
+            unsigned int results[FramesPerGame + 2] = {};   //frame i is at i + 2, so bonuses of first frames go to padding
+            size_t frame = 0;
+            size_t phase = 0;
+            size_t bonus = BonusNone;
+            for (size_t f = 0; f < FramesPerGame; ++f)
+                table.frames[f] = Frame(f + 1);
+
+            for (unsigned int pins : hits.hits)
+            {
+                if (frame == FramesPerGame || pins > AllPinsDown)
+                    return false;
+                const RollStep& step = RollSteps.steps[fsmRollStepIndex(frame == FramesPerGame - 1, phase, pins)];
+                if (!step.valid)
+                    return false;
+                const BonusStep& bonusStep = BonusSteps.steps[fsmBonusStepIndex(bonus, step.frameEnd)];
+                results[frame + 2] += pins;
+                results[frame + 1] += pins * bonusStep.paysPrev;
+                results[frame] += pins * bonusStep.paysPrevPrev;
+                table.frames[frame].hit.push_back(step.symbol);
+                frame += step.frameOver;
+                phase = step.nextPhase;
+                bonus = bonusStep.nextState;
+            }
+            if (frame != FramesPerGame)
+                return false;
+
+            table.playerName = hits.playerName;
+            table.total = 0;
+            for (size_t f = 0; f < FramesPerGame; ++f)
+            {
+                table.frames[f].result = results[f + 2];
+                table.total += results[f + 2];
+            }
+            return true;
+        }
+
+    protected:
+        void CalcPlayersRange(const PlayersHits& players, size_t begin, size_t end, PlayersTable& result, PlayersStatus& statuses) override
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!CalcTablePlayer(players[i], result[i]))
+                    statuses[i] = CalcPlayerTable(players[i], result[i]);
+            }
+        }
+    };
+
+    ///Looks games up in cache before scoring, only player name is copied for cached games
+    class CachingBowlingMachineImpl : public BowlingMachineImpl
+    {
+    private:
+        ScoreCache& m_cache;
+
+    protected:
+        void CalcPlayersRange(const PlayersHits& players, size_t begin, size_t end, PlayersTable& result, PlayersStatus& statuses) override
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                PlayerTable& table = result[i];
+                if (m_cache.Find(players[i].hits, table))
+                {
+                    table.playerName = players[i].playerName;
+                    continue;
+                }
+                statuses[i] = CalcPlayerTable(players[i], table);
+                if (statuses[i].Ok())
+                    m_cache.Insert(players[i].hits, table);
+            }
+        }
+
+    public:
+        explicit CachingBowlingMachineImpl(ScoreCache& cache)
+            : m_cache(cache)
+        {
+        }
+    };
+
+    ///Players scored by chunks on thread pool, multiple of BatchWidth to keep batches full
+    const size_t ParallelChunkSize = 64 * BatchWidth;
+
+    ///Scores chunks of players with Machine on thread pool threads, output has input order
+    template <class Machine>
+    class ParallelBowlingMachineImpl : public Machine
+    {
+    private:
+        ThreadPool& m_pool;
+
+    public:
+        template <class... Args>
+        explicit ParallelBowlingMachineImpl(ThreadPool& pool, Args&... args)
+            : Machine(args...)
+            , m_pool(pool)
+        {
+        }
+
+        PlayersTable TryCalcPlayersTable(const PlayersHits& players, PlayersStatus& statuses) override
+        {
+            PlayersTable result(players.size());
+            statuses.assign(players.size(), PlayerStatus());
+            m_pool.ParallelFor(players.size(), ParallelChunkSize, [this, &players, &result, &statuses](size_t begin, size_t end)
+            {
+                this->MeteredPlayersRange(players, begin, end, result, statuses);
+            });
             return result;
         }
     };
 
+    ///Keeps pending bonuses of at most two previous frames, so every roll updates
+    ///no more than three frames
+    class LiveGameImpl : public LiveGame
+    {
+    private:
+        ///Frame which waits for bonus rolls
+        struct Bonus
+        {
+            size_t frameIndex;
+            unsigned int rolls;
+        };
+
+        PlayerTable m_table;
+        std::array<FrameStatus, FramesPerGame> m_status;
+        std::array<Bonus, 2> m_bonuses;
+        size_t m_bonusCount;
+        size_t m_frameIndex;        //current frame
+        size_t m_frameRolls;        //rolls made in current frame
+        unsigned int m_firstPins;   //pins of the first roll of current frame
+        unsigned int m_standing;    //pins standing for the next roll
+
+        bool LastFrame() const
+        {
+            return m_frameIndex == FramesPerGame - 1;
+        }
+
+        ///Rolls of 10th frame: three after strike or spare, otherwise two
+        size_t LastFrameRolls() const
+        {
+            if (m_frameRolls >= 2 && m_table.frames[m_frameIndex].result >= AllPinsDown)
+                return 3;
+            return 2;
+        }
+
+        void AddBonus(unsigned int pins)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < m_bonusCount; ++i)
+            {
+                Bonus& bonus = m_bonuses[i];
+                m_table.frames[bonus.frameIndex].result += pins;
+                m_table.total += pins;
+                if (--bonus.rolls == 0)
+                    m_status[bonus.frameIndex] = FrameStatus::Final;
+                else
+                    m_bonuses[kept++] = bonus;
+            }
+            m_bonusCount = kept;
+        }
+
+        void NextFrame(unsigned int bonusRolls)
+        {
+            if (bonusRolls != 0)
+            {
+                m_status[m_frameIndex] = FrameStatus::Provisional;
+                m_bonuses[m_bonusCount++] = { m_frameIndex, bonusRolls };
+            }
+            else
+            {
+                m_status[m_frameIndex] = FrameStatus::Final;
+            }
+            ++m_frameIndex;
+            m_frameRolls = 0;
+            m_standing = AllPinsDown;
+        }
+
+    public:
+        explicit LiveGameImpl(const std::string& playerName)
+            : m_bonusCount(0)
+            , m_frameIndex(0)
+            , m_frameRolls(0)
+            , m_firstPins(0)
+            , m_standing(AllPinsDown)
+        {
+            m_table.playerName = playerName;
+            for (size_t i = 0; i < FramesPerGame; ++i)
+                m_table.frames[i] = Frame(i + 1);
+            m_status.fill(FrameStatus::NotStarted);
+        }
+
+        void AddRoll(unsigned int pins) override
+        {
+            if (IsOver())
+                throw std::runtime_error("Game is over");
+            if (pins > AllPinsDown)
+                throw std::runtime_error(scoreErrorMessage(ScoreError::HitTooBig));
+            if (pins > m_standing)
+                throw std::runtime_error(scoreErrorMessage(ScoreError::FrameOverflow));
+
+            AddBonus(pins);
+            Frame& frame = m_table.frames[m_frameIndex];
+            frame.result += pins;
+            m_table.total += pins;
+            m_status[m_frameIndex] = FrameStatus::Open;
+            ++m_frameRolls;
+            m_standing -= pins;
+
+            if (!LastFrame())
+            {
+                if (m_frameRolls == 1)
+                {
+                    m_firstPins = pins;
+                    if (pins == AllPinsDown)
+                    {
+                        frame.hit.push_back(StrikeSign);
+                        NextFrame(2);
+                    }
+                    else
+                    {
+                        frame.hit.push_back(MakeChar(pins));
+                    }
+                }
+                else
+                {
+                    const bool spare = m_firstPins + pins == AllPinsDown;
+                    frame.hit.push_back(spare ? SpareSign : MakeChar(pins));
+                    NextFrame(spare ? 1 : 0);
+                }
+                return;
+            }
+
+            //10th frame shows its bonus rolls as plain hits like getBowlingMachine() does
+            if (m_frameRolls == 1)
+                m_firstPins = pins;
+            const bool spare = m_frameRolls == 2 && m_firstPins != AllPinsDown && m_firstPins + pins == AllPinsDown;
+            frame.hit.push_back(spare ? SpareSign : MakeChar(pins));
+            if (m_standing == 0)
+                m_standing = AllPinsDown;
+            if (m_frameRolls == LastFrameRolls())
+            {
+                m_status[m_frameIndex] = FrameStatus::Final;
+                ++m_frameIndex;
+            }
+        }
+
+        const PlayerTable& Table() const override
+        {
+            return m_table;
+        }
+
+        FrameStatus GetFrameStatus(size_t frameIndex) const override
+        {
+            return m_status.at(frameIndex);
+        }
+
+        bool IsOver() const override
+        {
+            return m_frameIndex == FramesPerGame;
+        }
+    };
+
 } //namespace anonymous
 
 
-BowlingMachinePtr getBowlingMachine()
+std::string scoreErrorMessage(ScoreError error, unsigned int pinsPerFrame)
 {
-    return std::make_unique<BowlingMachineImpl>();
+    switch (error)
+    {
+    case ScoreError::None:
+        return "No error";
+    case ScoreError::HitTooBig:
+        return "Hit value is more then " + std::to_string(pinsPerFrame);
+    case ScoreError::FrameOverflow:
+        return "Frame value can be more than " + std::to_string(pinsPerFrame) + " only in case of spare or strike";
+    case ScoreError::NotEnoughHits:
+        return "Not enought hit values";
+    case ScoreError::TooManyHits:
+        return "Too many hit values";
+    }
+    return "Unknown error";
+}
+
+PlayersTable BowlingMachine::CalcPlayersTable(const PlayersHits& players)
+{
+    PlayersStatus statuses;
+    PlayersTable result = TryCalcPlayersTable(players, statuses);
+    for (const PlayerStatus& status : statuses)
+    {
+        if (!status.Ok())
+            throw std::runtime_error(ErrorMessage(status.error));
+    }
+    return result;
+}
+
+BowlingMachinePtr getBowlingMachine(const std::string& rules)
+{
+    if (rules == TenPinRules::Name())
+        return std::make_unique<BowlingMachineImpl>();
+    if (rules == CandlepinRules::Name())
+        return std::make_unique<RulesBowlingMachineImpl<CandlepinRules>>();
+    if (rules == NinePinRules::Name())
+        return std::make_unique<RulesBowlingMachineImpl<NinePinRules>>();
+    throw std::runtime_error("Unknown bowling rules " + rules);
+}
+
+BowlingMachinePtr getBatchBowlingMachine()
+{
+    return std::make_unique<BatchBowlingMachineImpl>();
+}
+
+BowlingMachinePtr getParallelBowlingMachine(ThreadPool& pool)
+{
+    return std::make_unique<ParallelBowlingMachineImpl<BowlingMachineImpl>>(pool);
+}
+
+BowlingMachinePtr getParallelBatchBowlingMachine(ThreadPool& pool)
+{
+    return std::make_unique<ParallelBowlingMachineImpl<BatchBowlingMachineImpl>>(pool);
+}
+
+BowlingMachinePtr getTableBowlingMachine()
+{
+    return std::make_unique<TableBowlingMachineImpl>();
+}
+
+BowlingMachinePtr getParallelTableBowlingMachine(ThreadPool& pool)
+{
+    return std::make_unique<ParallelBowlingMachineImpl<TableBowlingMachineImpl>>(pool);
+}
+
+BowlingMachinePtr getCachingBowlingMachine(ScoreCache& cache)
+{
+    return std::make_unique<CachingBowlingMachineImpl>(cache);
+}
+
+BowlingMachinePtr getParallelCachingBowlingMachine(ThreadPool& pool, ScoreCache& cache)
+{
+    return std::make_unique<ParallelBowlingMachineImpl<CachingBowlingMachineImpl>>(pool, cache);
+}
+
+LiveGamePtr getLiveGame(const std::string& playerName)
+{
+    return std::make_unique<LiveGameImpl>(playerName);
 }
 
 #ifdef UNITTEST
 
 #include "gtest/gtest.h"
+#include "game_generator.h"
 
 ///Table without misses, strikes and spares
 TEST(bowlingMachine, simpleTable)
@@ -535,5 +1102,337 @@ TEST(bowlingMachine, minPoints)
     EXPECT_EQ(result.total, 0);
 }
 
-#endif
+namespace //anonymous
+{
+    ///Valid games of game generator with given seed
+    PlayersHits MakeRandomGames(uint64_t seed, size_t playerCount)
+    {
+        GeneratorOptions options;
+        options.seed = seed;
+        PlayersHits players(playerCount);
+        for (size_t i = 0; i < playerCount; ++i)
+            generatePlayer(options, i, players[i]);
+        return players;
+    }
+}   //namespace anonymous
+
+///Batch machine gives the same tables as scalar one, wrong games fall back to scalar scoring
+TEST(bowlingMachine, batchMatchesScalar)
+{
+    PlayersHits players = MakeRandomGames(1, 1000);
+    players.push_back({ "AllStrikes", Hits(12, 10) });
+    players.push_back({ "AllMisses", Hits(20, 0) });
+    players.push_back({ "Incomplete", { 1, 2, 3, 4 } });
+    players.push_back({ "TenthFrameUnchecked", { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 15, 3 } });
 
+    const PlayersTable expected = getBowlingMachine()->CalcPlayersTable(players);
+    const PlayersTable result = getBatchBowlingMachine()->CalcPlayersTable(players);
+    ASSERT_EQ(expected.size(), result.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].playerName, result[i].playerName);
+        for (size_t f = 0; f < FramesPerGame; ++f)
+            EXPECT_EQ(expected[i].frames[f], result[i].frames[f]);
+        EXPECT_EQ(expected[i].total, result[i].total);
+    }
+
+    players.push_back({ "Wrong", { 5, 6 } });
+    EXPECT_THROW(getBatchBowlingMachine()->CalcPlayersTable(players), std::runtime_error);
+}
+
+///Parallel machines keep players order and throw the error of the first wrong player
+TEST(bowlingMachine, parallelMatchesSequential)
+{
+    PlayersHits players = MakeRandomGames(2, 5000);
+
+    ThreadPool pool(4);
+    const PlayersTable expected = getBowlingMachine()->CalcPlayersTable(players);
+    for (const PlayersTable& result : { getParallelBowlingMachine(pool)->CalcPlayersTable(players),
+        getParallelBatchBowlingMachine(pool)->CalcPlayersTable(players) })
+    {
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].playerName, result[i].playerName);
+            EXPECT_EQ(expected[i].total, result[i].total);
+        }
+    }
+
+    players[1500].hits = { 11 };
+    players[4500].hits = { 10, 10 };
+    for (int run = 0; run < 10; ++run)
+    {
+        try
+        {
+            getParallelBatchBowlingMachine(pool)->CalcPlayersTable(players);
+            FAIL();
+        }
+        catch (const std::runtime_error& e)
+        {
+            EXPECT_STREQ(e.what(), "Hit value is more then 10");
+        }
+    }
+}
+
+///Game fed roll by roll ends with the same table as the machine gives for all its rolls
+TEST(liveGame, matchesMachine)
+{
+    PlayersHits players = MakeRandomGames(3, 1000);
+    players.push_back({ "AllStrikes", Hits(12, 10) });
+    players.push_back({ "AllMisses", Hits(20, 0) });
+
+    const PlayersTable expected = getBowlingMachine()->CalcPlayersTable(players);
+    for (size_t i = 0; i < players.size(); ++i)
+    {
+        LiveGamePtr game = getLiveGame(players[i].playerName);
+        for (unsigned int pins : players[i].hits)
+        {
+            ASSERT_FALSE(game->IsOver());
+            game->AddRoll(pins);
+        }
+        EXPECT_TRUE(game->IsOver());
+        const PlayerTable& result = game->Table();
+        EXPECT_EQ(expected[i].playerName, result.playerName);
+        for (size_t f = 0; f < FramesPerGame; ++f)
+        {
+            EXPECT_EQ(expected[i].frames[f], result.frames[f]);
+            EXPECT_EQ(game->GetFrameStatus(f), FrameStatus::Final);
+        }
+        EXPECT_EQ(expected[i].total, result.total);
+    }
+}
+
+///Strike and spare stay provisional until their bonus rolls are made
+TEST(liveGame, provisionalFrames)
+{
+    LiveGamePtr game = getLiveGame("Dude");
+    game->AddRoll(10);
+    EXPECT_EQ(game->GetFrameStatus(0), FrameStatus::Provisional);
+    EXPECT_EQ(game->GetFrameStatus(1), FrameStatus::NotStarted);
+    game->AddRoll(7);
+    EXPECT_EQ(game->GetFrameStatus(1), FrameStatus::Open);
+    EXPECT_EQ(game->Table().frames[0].result, 17);
+    game->AddRoll(3);
+    EXPECT_EQ(game->GetFrameStatus(0), FrameStatus::Final);
+    EXPECT_EQ(game->GetFrameStatus(1), FrameStatus::Provisional);
+    EXPECT_EQ(game->Table().frames[0].result, 20);
+    EXPECT_EQ(game->Table().frames[1].hit, FrameHits({ '7', SpareSign }));
+    EXPECT_EQ(game->Table().total, 30);
+    game->AddRoll(4);
+    EXPECT_EQ(game->GetFrameStatus(1), FrameStatus::Final);
+    EXPECT_EQ(game->Table().frames[1].result, 14);
+    EXPECT_EQ(game->Table().total, 38);
+}
+
+///Impossible rolls are rejected and don't change the game
+TEST(liveGame, wrongRolls)
+{
+    LiveGamePtr game = getLiveGame("Walter");
+    EXPECT_THROW(game->AddRoll(11), std::runtime_error);
+    game->AddRoll(6);
+    EXPECT_THROW(game->AddRoll(5), std::runtime_error);
+    EXPECT_EQ(game->Table().total, 6);
+    for (size_t i = 0; i < 19; ++i)
+        game->AddRoll(0);
+    EXPECT_TRUE(game->IsOver());
+    EXPECT_THROW(game->AddRoll(0), std::runtime_error);
+}
+
+//games of the tests above checked at compile time by the state machine
+constexpr unsigned int SimpleTableHits[] = { 1, 1, 2, 2, 3, 3, 4, 4, 5, 4, 6, 3, 7, 2, 8, 1, 8, 1, 1, 2 };
+constexpr unsigned int SimpleSpareHits[] = { 1, 9, 2, 2, 3, 7, 4, 4, 5, 4, 6, 3, 7, 2, 8, 1, 9, 1, 1, 2 };
+constexpr unsigned int SimpleStrikeHits[] = { 1, 1, 10, 3, 3, 10, 10, 6, 3, 7, 2, 8, 1, 8, 1, 1, 2 };
+constexpr unsigned int TenFrameSpareHits[] = { 1, 1, 2, 2, 3, 3, 4, 4, 5, 4, 6, 3, 7, 2, 8, 1, 8, 1, 2, 8, 5 };
+constexpr unsigned int TenFrameStrikeHits[] = { 1, 1, 2, 2, 3, 3, 4, 4, 5, 4, 6, 3, 7, 2, 8, 1, 8, 1, 10, 4, 5 };
+constexpr unsigned int MissHits[] = { 1, 1, 2, 0, 3, 3, 4, 4, 5, 4, 6, 3, 0, 2, 8, 1, 0, 10, 1, 2 };
+constexpr unsigned int ComplexHits[] = { 0, 10, 2, 0, 10, 4, 4, 5, 5, 0, 3, 7, 3, 10, 8, 1, 10, 10, 10 };
+constexpr unsigned int MaxPointsHits[] = { 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10 };
+constexpr unsigned int MinPointsHits[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+constexpr unsigned int IncompleteHits[] = { 1, 1, 10, 5 };
+constexpr unsigned int FrameOverflowHits[] = { 5, 6 };
+static_assert(fsmScoreGame(SimpleTableHits) == 68, "simpleTable");
+static_assert(fsmScoreGame(SimpleSpareHits) == 88, "simpleSpare");
+static_assert(fsmScoreGame(SimpleSpareHits, 0) == 12, "simpleSpare frame 1");
+static_assert(fsmScoreGame(SimpleStrikeHits) == 108, "simpleStrike");
+static_assert(fsmScoreGame(SimpleStrikeHits, 3) == 26, "simpleStrike frame 4");
+static_assert(fsmScoreGame(TenFrameSpareHits) == 80, "tenFrameSpare");
+static_assert(fsmScoreGame(TenFrameStrikeHits, FramesPerGame - 1) == 19, "tenFrameStrike frame 10");
+static_assert(fsmScoreGame(MissHits) == 61, "miss");
+static_assert(fsmScoreGame(ComplexHits) == 131, "complex");
+static_assert(fsmScoreGame(ComplexHits, 6) == 20, "complex frame 7");
+static_assert(fsmScoreGame(MaxPointsHits) == 300, "maxPoints");
+static_assert(fsmScoreGame(MinPointsHits) == 0, "minPoints");
+static_assert(fsmScoreGame(IncompleteHits) == InvalidScore, "incomplete game");
+static_assert(fsmScoreGame(FrameOverflowHits) == InvalidScore, "frame over 10 pins");
+
+///Table machine gives the same tables and errors as scalar one
+TEST(bowlingMachine, tableMatchesScalar)
+{
+    PlayersHits players = MakeRandomGames(4, 1000);
+    players.push_back({ "AllStrikes", Hits(12, 10) });
+    players.push_back({ "Incomplete", { 1, 2, 3, 4 } });
+    players.push_back({ "TenthFrameUnchecked", { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 5, 9 } });
+
+    const PlayersTable expected = getBowlingMachine()->CalcPlayersTable(players);
+    const PlayersTable result = getTableBowlingMachine()->CalcPlayersTable(players);
+    ASSERT_EQ(expected.size(), result.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].playerName, result[i].playerName);
+        for (size_t f = 0; f < FramesPerGame; ++f)
+            EXPECT_EQ(expected[i].frames[f], result[i].frames[f]);
+        EXPECT_EQ(expected[i].total, result[i].total);
+    }
+
+    players.push_back({ "Wrong", { 5, 6 } });
+    EXPECT_THROW(getTableBowlingMachine()->CalcPlayersTable(players), std::runtime_error);
+}
+
+///Wrong players get error and hit index without exceptions, others are scored as usual
+TEST(bowlingMachine, tryCalcStatuses)
+{
+    PlayersHits players = MakeRandomGames(5, 100);
+    players[10].hits[3] = 11;
+    players[20].hits = { 5, 6 };
+    players[30].hits = { 10, 10 };
+    players[40].hits = Hits(42, 1);
+    players[50].hits = Hits(13, 10);
+    const PlayersTable expected = getBowlingMachine()->CalcPlayersTable({ players[0], players[99] });
+
+    ThreadPool pool(2);
+    ScoreCache cache(1024 * 1024);
+    BowlingMachinePtr machines[] = { getBowlingMachine(), getBatchBowlingMachine(), getTableBowlingMachine(),
+        getParallelBowlingMachine(pool), getParallelBatchBowlingMachine(pool), getParallelTableBowlingMachine(pool),
+        getCachingBowlingMachine(cache) };
+    for (BowlingMachinePtr& machine : machines)
+    {
+        PlayersStatus statuses;
+        const PlayersTable result = machine->TryCalcPlayersTable(players, statuses);
+        ASSERT_EQ(statuses.size(), players.size());
+        EXPECT_EQ(std::count_if(statuses.begin(), statuses.end(), [](const PlayerStatus& status) { return !status.Ok(); }), 5);
+        EXPECT_EQ(statuses[10].error, ScoreError::HitTooBig);
+        EXPECT_EQ(statuses[10].hitIndex, 3);
+        EXPECT_EQ(statuses[20].error, ScoreError::FrameOverflow);
+        EXPECT_EQ(statuses[20].hitIndex, 1);
+        EXPECT_EQ(statuses[30].error, ScoreError::NotEnoughHits);
+        EXPECT_EQ(statuses[40].error, ScoreError::TooManyHits);
+        EXPECT_EQ(statuses[40].hitIndex, 20);
+        EXPECT_EQ(statuses[50].error, ScoreError::TooManyHits);
+        EXPECT_EQ(statuses[50].hitIndex, 12);
+        EXPECT_EQ(result[0].total, expected[0].total);
+        EXPECT_EQ(result[99].total, expected[1].total);
+
+        try
+        {
+            machine->CalcPlayersTable(players);
+            FAIL();
+        }
+        catch (const std::runtime_error& e)
+        {
+            EXPECT_EQ(e.what(), scoreErrorMessage(ScoreError::HitTooBig));
+        }
+    }
+}
+
+///Scored players, strikes, spares and errors are counted only while metrics are enabled
+TEST(bowlingMachine, metrics)
+{
+    const PlayersHits players = { { "Dude", Hits(12, 10) }, { "Walter", { 10, 10 } }, { "Donny", Hits(21, 5) } };
+    PlayersStatus statuses;
+    ThreadPool pool(2);
+    BowlingMachinePtr machines[] = { getBowlingMachine(), getParallelBatchBowlingMachine(pool) };
+    for (BowlingMachinePtr& machine : machines)
+    {
+        resetMetrics();
+        enableMetrics(true);
+        machine->TryCalcPlayersTable(players, statuses);
+        enableMetrics(false);
+        machine->TryCalcPlayersTable(players, statuses);
+        const MetricsSnapshot metrics = getMetrics();
+        EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::PlayersScored)], 2u);
+        EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::Strikes)], 12u);
+        EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::Spares)], 10u);
+        EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::Errors)], 1u);
+    }
+}
+
+///Machines of other rules are selected by name
+TEST(bowlingMachine, rulesVariants)
+{
+    EXPECT_THROW(getBowlingMachine("duckpin"), std::runtime_error);
+
+    const PlayersHits tenPin = { { "Perfect", Hits(12, 10) } };
+    EXPECT_EQ(getBowlingMachine("tenpin")->CalcPlayersTable(tenPin)[0].total, 300);
+
+    //candlepin: three balls per frame, ten pins cleared by the third ball get no bonus
+    const PlayersHits candlepin =
+    {
+        {
+            "Candle",
+            {
+                10,         //frame1: 10 + 5 + 5 = 20
+                5, 5,       //frame2: spare, 10 + 3 = 13
+                3, 4, 3,    //frame3: ten-box, 10
+                1, 2, 3,    //frame4: 6
+                0, 0, 0,    //frame5: 0
+                2, 2, 2,    //frame6: 6
+                4, 3, 2,    //frame7: 9
+                5, 4, 0,    //frame8: 9
+                9, 0, 0,    //frame9: 9
+                10, 10, 7,  //frame10: 27
+            }
+        },
+    };
+    const PlayerTable candle = getBowlingMachine("candlepin")->CalcPlayersTable(candlepin)[0];
+    EXPECT_EQ(candle.frames[0].result, 20);
+    EXPECT_EQ(candle.frames[1].result, 13);
+    EXPECT_EQ(candle.frames[2].result, 10);
+    EXPECT_EQ(candle.frames[2].hit, FrameHits({ '3', '4', '3' }));
+    EXPECT_EQ(candle.frames[3].hit, FrameHits({ '1', '2', '3' }));
+    EXPECT_EQ(candle.frames[9].hit, FrameHits({ StrikeSign, StrikeSign, '7' }));
+    EXPECT_EQ(candle.total, 20 + 13 + 10 + 6 + 0 + 6 + 9 + 9 + 9 + 27);
+
+    //nine-pin: all nine pins down by the first ball is a strike
+    const PlayersHits ninePin = { { "Perfect", Hits(12, 9) }, { "Wrong", { 10, 0 } } };
+    PlayersStatus statuses;
+    BowlingMachinePtr nineMachine = getBowlingMachine("ninepin");
+    const PlayersTable nine = nineMachine->TryCalcPlayersTable(ninePin, statuses);
+    EXPECT_EQ(nine[0].total, 270);
+    EXPECT_EQ(nine[0].frames[9].hit, FrameHits({ StrikeSign, StrikeSign, StrikeSign }));
+    EXPECT_EQ(statuses[1].error, ScoreError::HitTooBig);
+    EXPECT_EQ(nineMachine->ErrorMessage(statuses[1].error), "Hit value is more then 9");
+    EXPECT_EQ(getBowlingMachine()->ErrorMessage(ScoreError::HitTooBig), "Hit value is more then 10");
+}
+
+///Caching machines give the same tables and errors, repeated games are taken from cache
+TEST(bowlingMachine, cachingMatchesScalar)
+{
+    PlayersHits players = MakeRandomGames(6, 100);
+    for (size_t i = 0; i < 1000; ++i)
+        players.push_back({ "Repeat" + std::to_string(i), players[i % 100].hits });
+    players[500].hits = { 5, 6 };
+
+    PlayersStatus expectedStatuses;
+    const PlayersTable expected = getBowlingMachine()->TryCalcPlayersTable(players, expectedStatuses);
+    ScoreCache cache(1 << 20);
+    ThreadPool pool(4);
+    BowlingMachinePtr machines[] = { getCachingBowlingMachine(cache), getParallelCachingBowlingMachine(pool, cache) };
+    for (BowlingMachinePtr& machine : machines)
+    {
+        PlayersStatus statuses;
+        const PlayersTable result = machine->TryCalcPlayersTable(players, statuses);
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].playerName, result[i].playerName);
+            EXPECT_EQ(expected[i].total, result[i].total);
+            EXPECT_EQ(expectedStatuses[i].error, statuses[i].error);
+        }
+    }
+    const ScoreCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.entries, 100);
+    EXPECT_EQ(stats.misses, 100 + 2);   //wrong game isn't cached
+    EXPECT_EQ(stats.hits, 2 * players.size() - stats.misses);
+}
+
+#endif
@@ -2,17 +2,114 @@
 #define BOWLING_MACHINE_H
 
 #include "types.h"
+#include "thread_pool.h"
 
 #include <memory>
+#include <string>
+
+enum class ScoreError
+{
+    None,
+    HitTooBig,          ///hit is more than pins of the rules
+    FrameOverflow,      ///frame hits are more than pins of the rules
+    NotEnoughHits,      ///strike or spare has no bonus hits
+    TooManyHits,        ///hits after the last frame
+};
+
+///Message of the error, the same std::runtime_error has when thrown, for rules with pinsPerFrame pins
+std::string scoreErrorMessage(ScoreError error, unsigned int pinsPerFrame = AllPinsDown);
+
+///Scoring result of one player
+struct PlayerStatus
+{
+    PlayerStatus()
+        : error(ScoreError::None)
+        , hitIndex(0)
+    {
+    }
+
+    PlayerStatus(ScoreError i_error, size_t i_hitIndex)
+        : error(i_error)
+        , hitIndex(i_hitIndex)
+    {
+    }
+
+    bool Ok() const { return error == ScoreError::None; }
+
+    ScoreError error;
+    size_t hitIndex;    ///index of the wrong hit in player hits
+};
+
+typedef std::vector<PlayerStatus> PlayersStatus;
 
 class BowlingMachine
 {
 public:
-    virtual PlayersTable CalcPlayersTable(const PlayersHits& players) = 0;
+    virtual ~BowlingMachine() {}
+
+    ///Score all players, throws std::runtime_error with the error of the first wrong player
+    PlayersTable CalcPlayersTable(const PlayersHits& players);
+
+    ///Score all players without exceptions. statuses[i] is the result of players[i],
+    ///table of wrong player has only frames before the wrong hit
+    virtual PlayersTable TryCalcPlayersTable(const PlayersHits& players, PlayersStatus& statuses) = 0;
+
+    ///Message of the error under rules of the machine
+    virtual std::string ErrorMessage(ScoreError error) const { return scoreErrorMessage(error); }
 };
 
 typedef std::unique_ptr<BowlingMachine> BowlingMachinePtr;
 
-BowlingMachinePtr getBowlingMachine();
+///Scalar machine for the rules: "tenpin", "candlepin" or "ninepin" (see rules.h).
+///Throws std::runtime_error for unknown rules
+BowlingMachinePtr getBowlingMachine(const std::string& rules = "tenpin");
+
+///Machine which scores games by batches of BatchWidth games with vectorized code.
+///Gives the same results and errors as getBowlingMachine()
+BowlingMachinePtr getBatchBowlingMachine();
+
+///Machine which scores games by lookups into compile-time state machine tables.
+///Gives the same results and errors as getBowlingMachine()
+BowlingMachinePtr getTableBowlingMachine();
+
+///Machines which score chunks of players on pool threads, results keep players order
+BowlingMachinePtr getParallelBowlingMachine(ThreadPool& pool);
+BowlingMachinePtr getParallelBatchBowlingMachine(ThreadPool& pool);
+BowlingMachinePtr getParallelTableBowlingMachine(ThreadPool& pool);
+
+class ScoreCache;
+///Scalar machines which take games with the same hits from cache instead of scoring them again
+BowlingMachinePtr getCachingBowlingMachine(ScoreCache& cache);
+BowlingMachinePtr getParallelCachingBowlingMachine(ThreadPool& pool, ScoreCache& cache);
+
+///State of a frame during live game
+enum class FrameStatus
+{
+    NotStarted,
+    Open,           ///frame rolls are not over
+    Provisional,    ///rolls are over, strike or spare waits for bonus rolls
+    Final,
+};
+
+///Game scored roll by roll as balls are thrown, every roll costs O(1)
+class LiveGame
+{
+public:
+    virtual ~LiveGame() {}
+
+    ///Add pins knocked down by the next roll. Throws std::runtime_error if it is more than pins
+    ///standing or the game is over, the game is left unchanged then
+    virtual void AddRoll(unsigned int pins) = 0;
+
+    ///Current table. Results of provisional frames and total include only bonus rolls made so far,
+    ///frames of complete game are the same as getBowlingMachine() gives
+    virtual const PlayerTable& Table() const = 0;
+    virtual FrameStatus GetFrameStatus(size_t frameIndex) const = 0;
+    virtual bool IsOver() const = 0;
+};
+
+typedef std::unique_ptr<LiveGame> LiveGamePtr;
+
+LiveGamePtr getLiveGame(const std::string& playerName);
 
 #endif //BOWLING_MACHINE_H
@@ -1,6 +1,8 @@
 #ifndef CONST_H
 #define CONST_H
 
+#include <cstddef>
+
 const char SpareSign = '/';
 const char StrikeSign = 'x';
 const char MissSign = '-';
@@ -9,4 +11,6 @@ const size_t FramesPerGame = 10;
 
 const size_t AllPinsDown = 10;
 
+const size_t MaxHitsPerFrame = 3;   ///strike or spare in 10th frame gives extra hits
+
 #endif //CONST_H
\ No newline at end of file
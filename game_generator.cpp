@@ -0,0 +1,378 @@
+#include "game_generator.h"
+#include "binary_hits.h"
+#include "const.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace //anonymous
+{
+    ///Players generated by one task
+    const size_t GenerateChunkSize = 4096;
+    ///Name length of binary format is 16-bit
+    const size_t MaxNameLength = 0xffff;
+    ///Too big hits still fit into 4 bits of binary format
+    const unsigned int MaxInvalidHit = 15;
+
+    enum InvalidGame
+    {
+        HitTooBig,
+        FrameOverflow,
+        NoBonusHits,
+        InvalidGameCount,
+    };
+
+    ///SplitMix64 generator. Its output is the same with every compiler and standard library
+    ///unlike distributions of <random>, so files are reproducible anywhere. Every 64-bit value
+    ///gives two 32-bit draws, which is enough for rates and small ranges
+    class GameRandom
+    {
+    public:
+        ///Stream of every player is seeded by its index, players don't depend on each other
+        GameRandom(uint64_t seed, uint64_t index)
+            : m_state(Mix(seed + Mix(index)))
+            , m_half(0)
+            , m_hasHalf(false)
+        {
+        }
+
+        uint32_t Next()
+        {
+            if (m_hasHalf)
+            {
+                m_hasHalf = false;
+                return m_half;
+            }
+            m_state += 0x9e3779b97f4a7c15ull;
+            const uint64_t value = Mix(m_state);
+            m_half = static_cast<uint32_t>(value);
+            m_hasHalf = true;
+            return static_cast<uint32_t>(value >> 32);
+        }
+
+        ///Number in [0, range)
+        unsigned int Below(size_t range)
+        {
+            return static_cast<unsigned int>((static_cast<uint64_t>(Next()) * range) >> 32);
+        }
+
+        bool Chance(double rate)
+        {
+            return static_cast<double>(Next()) < rate * 4294967296.0;
+        }
+
+    private:
+        static uint64_t Mix(uint64_t value)
+        {
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+
+        uint64_t m_state;
+        uint32_t m_half;
+        bool m_hasHalf;
+    };
+
+    void CheckRate(double rate, const char* name)
+    {
+        if (!(rate >= 0 && rate <= 1))
+            throw std::runtime_error(std::string(name) + " must be from 0 to 1");
+    }
+
+    void CheckOptions(const GeneratorOptions& options)
+    {
+        CheckRate(options.strikeRate, "Strike rate");
+        CheckRate(options.spareRate, "Spare rate");
+        CheckRate(options.missRate, "Miss rate");
+        CheckRate(options.invalidRate, "Invalid rate");
+        if (options.minNameLength == 0 || options.minNameLength > options.maxNameLength || options.maxNameLength > MaxNameLength)
+            throw std::runtime_error("Name lengths must be from 1 to " + std::to_string(MaxNameLength) + ", minimal one not more than maximal");
+    }
+
+    ///Roll which leaves some of standing pins: miss or 1..maxPins
+    unsigned int RollPart(GameRandom& random, const GeneratorOptions& options, unsigned int maxPins)
+    {
+        if (maxPins == 0 || random.Chance(options.missRate))
+            return 0;
+        return 1 + random.Below(maxPins);
+    }
+
+    unsigned int RollFirst(GameRandom& random, const GeneratorOptions& options)
+    {
+        if (random.Chance(options.strikeRate))
+            return AllPinsDown;
+        return RollPart(random, options, AllPinsDown - 1);
+    }
+
+    unsigned int RollSecond(GameRandom& random, const GeneratorOptions& options, unsigned int first)
+    {
+        const unsigned int standing = AllPinsDown - first;
+        if (random.Chance(options.spareRate))
+            return standing;
+        return RollPart(random, options, standing - 1);
+    }
+
+    ///Returns index of the first hit of 10th frame
+    size_t GenerateHits(GameRandom& random, const GeneratorOptions& options, Hits& hits)
+    {
+        for (size_t frame = 1; frame < FramesPerGame; ++frame)
+        {
+            const unsigned int first = RollFirst(random, options);
+            hits.push_back(first);
+            if (first != AllPinsDown)
+                hits.push_back(RollSecond(random, options, first));
+        }
+
+        //10th frame owns its bonus hits: two after strike, one after spare
+        const size_t lastFrame = hits.size();
+        const unsigned int first = RollFirst(random, options);
+        const unsigned int second = first == AllPinsDown ? RollFirst(random, options) : RollSecond(random, options, first);
+        hits.push_back(first);
+        hits.push_back(second);
+        if (first == AllPinsDown && second != AllPinsDown)
+            hits.push_back(RollSecond(random, options, second));
+        else if (first == AllPinsDown || first + second == AllPinsDown)
+            hits.push_back(RollFirst(random, options));
+        return lastFrame;
+    }
+
+    ///Spoil valid game, so scoring rejects it while parser accepts the line
+    void SpoilHits(GameRandom& random, Hits& hits, size_t lastFrame)
+    {
+        switch (random.Below(InvalidGameCount))
+        {
+        case HitTooBig:
+            hits[random.Below(hits.size())] = AllPinsDown + 1 + random.Below(MaxInvalidHit - AllPinsDown);
+            break;
+        case FrameOverflow:
+            //the first frame becomes two hits with one pin more than there are
+            if (hits[0] == AllPinsDown)
+                hits.insert(hits.begin() + 1, 0);
+            hits[0] = 1 + random.Below(AllPinsDown - 1);
+            hits[1] = AllPinsDown + 1 - hits[0];
+            break;
+        default:
+            //10th frame loses its last bonus hit, or its open frame becomes spare without bonus
+            if (hits.size() - lastFrame == 3)
+                hits.pop_back();
+            else
+                hits.back() = AllPinsDown - hits[lastFrame];
+            break;
+        }
+    }
+
+    ///Line is formatted in place, hits are less than 100
+    void AppendTextLine(std::string& buffer, const PlayerHits& player)
+    {
+        const size_t start = buffer.size();
+        buffer.resize(start + player.playerName.size() + 1 + 3 * player.hits.size() + 1);
+        char* out = &buffer[start];
+        out = std::copy(player.playerName.begin(), player.playerName.end(), out);
+        *out++ = ':';
+        for (unsigned int hit : player.hits)
+        {
+            *out++ = ' ';
+            if (hit >= 10)
+                *out++ = static_cast<char>('0' + hit / 10);
+            *out++ = static_cast<char>('0' + hit % 10);
+        }
+        *out++ = '\n';
+        buffer.resize(static_cast<size_t>(out - buffer.data()));
+    }
+
+    ///Chunks of a window are generated by pool threads at once, then written in file order
+    template <class Chunk, class Fill, class Write>
+    void GenerateChunks(const GeneratorOptions& options, ThreadPool& pool, const Fill& fill, const Write& write)
+    {
+        CheckOptions(options);
+        const size_t chunkCount = (options.playerCount + GenerateChunkSize - 1) / GenerateChunkSize;
+        std::vector<Chunk> chunks(std::min(chunkCount, 4 * pool.ThreadCount()));
+        for (size_t first = 0; first < chunkCount; first += chunks.size())
+        {
+            const size_t count = std::min(chunks.size(), chunkCount - first);
+            pool.ParallelFor(count, 1, [&options, &chunks, &fill, first](size_t begin, size_t end)
+            {
+                PlayerHits player;
+                for (size_t chunk = begin; chunk < end; ++chunk)
+                {
+                    const size_t last = std::min(options.playerCount, (first + chunk + 1) * GenerateChunkSize);
+                    for (size_t i = (first + chunk) * GenerateChunkSize; i < last; ++i)
+                    {
+                        generatePlayer(options, i, player);
+                        fill(chunks[chunk], player);
+                    }
+                }
+            });
+            for (size_t chunk = 0; chunk < count; ++chunk)
+                write(chunks[chunk]);
+        }
+    }
+
+}   //namespace anonymous
+
+GeneratorOptions::GeneratorOptions()
+    : seed(1)
+    , playerCount(0)
+    , strikeRate(0.3)
+    , spareRate(0.3)
+    , missRate(0.1)
+    , minNameLength(4)
+    , maxNameLength(12)
+    , invalidRate(0)
+{
+}
+
+void generatePlayer(const GeneratorOptions& options, size_t index, PlayerHits& player)
+{
+    CheckOptions(options);
+    GameRandom random(options.seed, index);
+    player.playerName.resize(options.minNameLength + random.Below(options.maxNameLength - options.minNameLength + 1));
+    for (size_t i = 0; i < player.playerName.size(); ++i)
+        player.playerName[i] = static_cast<char>((i == 0 ? 'A' : 'a') + random.Below(26));
+
+    player.hits.clear();
+    const size_t lastFrame = GenerateHits(random, options, player.hits);
+    if (random.Chance(options.invalidRate))
+        SpoilHits(random, player.hits, lastFrame);
+}
+
+void generateTextFile(const std::string& filename, const GeneratorOptions& options, ThreadPool& pool)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Can't open file " + filename);
+    GenerateChunks<std::string>(options, pool,
+        [](std::string& chunk, const PlayerHits& player) { AppendTextLine(chunk, player); },
+        [&out](std::string& chunk)
+        {
+            out.write(chunk.data(), chunk.size());
+            chunk.clear();
+        });
+    out.flush();
+    if (!out)
+        throw std::runtime_error("Can't write file " + filename);
+}
+
+void generateBinaryFile(const std::string& filename, const GeneratorOptions& options, ThreadPool& pool)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Can't open file " + filename);
+    BinaryHitsWriter writer(out);
+    GenerateChunks<PlayersHits>(options, pool,
+        [](PlayersHits& chunk, const PlayerHits& player) { chunk.push_back(player); },
+        [&writer](PlayersHits& chunk)
+        {
+            for (const PlayerHits& player : chunk)
+                writer.Write(player);
+            chunk.clear();
+        });
+    writer.Finish();
+    out.flush();
+    if (!out)
+        throw std::runtime_error("Can't write file " + filename);
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include "bowling_machine.h"
+#include "input_parser.h"
+
+namespace //anonymous
+{
+    void ExpectSamePlayers(const PlayersHits& players, const PlayersHits& expected)
+    {
+        ASSERT_EQ(players.size(), expected.size());
+        for (size_t i = 0; i < players.size(); ++i)
+        {
+            EXPECT_EQ(players[i].playerName, expected[i].playerName);
+            EXPECT_EQ(players[i].hits, expected[i].hits);
+        }
+    }
+}   //namespace anonymous
+
+///Generated file doesn't depend on thread count, it is read back as generated players
+TEST(gameGenerator, deterministicFile)
+{
+    GeneratorOptions options;
+    options.seed = 42;
+    options.playerCount = 3 * GenerateChunkSize + 5;
+    options.invalidRate = 0.1;
+
+    const std::string filename = "game_generator_test.tmp";
+    ThreadPool single(1);
+    generateTextFile(filename, options, single);
+    const PlayersHits players = getMappedInputParser()->ParseFile(filename);
+    ThreadPool pool(4);
+    generateTextFile(filename, options, pool);
+    ExpectSamePlayers(getMappedInputParser()->ParseFile(filename), players);
+
+    ASSERT_EQ(players.size(), options.playerCount);
+    PlayerHits player;
+    for (size_t i = 0; i < players.size(); i += 97)
+    {
+        generatePlayer(options, i, player);
+        EXPECT_EQ(players[i].playerName, player.playerName);
+        EXPECT_EQ(players[i].hits, player.hits);
+    }
+
+    generateBinaryFile(filename, options, pool);
+    EXPECT_TRUE(isBinaryHitsFile(filename));
+    ExpectSamePlayers(getBinaryInputParser()->ParseFile(filename), players);
+    std::remove(filename.c_str());
+
+    options.seed = 43;
+    generatePlayer(options, 0, player);
+    EXPECT_NE(player.playerName, players[0].playerName);
+}
+
+///Games follow the distribution, the invalid ones are rejected by scoring
+TEST(gameGenerator, distribution)
+{
+    GeneratorOptions options;
+    options.playerCount = 2000;
+    options.minNameLength = 3;
+    options.maxNameLength = 5;
+    options.invalidRate = 0.25;
+
+    PlayersHits players(options.playerCount);
+    for (size_t i = 0; i < players.size(); ++i)
+        generatePlayer(options, i, players[i]);
+    PlayersStatus statuses;
+    getBowlingMachine()->TryCalcPlayersTable(players, statuses);
+    size_t invalid = 0;
+    for (size_t i = 0; i < players.size(); ++i)
+    {
+        EXPECT_GE(players[i].playerName.size(), 3u);
+        EXPECT_LE(players[i].playerName.size(), 5u);
+        if (!statuses[i].Ok())
+            ++invalid;
+    }
+    EXPECT_GT(invalid, 400u);
+    EXPECT_LT(invalid, 600u);
+
+    options.invalidRate = 0;
+    for (size_t i = 0; i < players.size(); ++i)
+        generatePlayer(options, i, players[i]);
+    getBowlingMachine()->TryCalcPlayersTable(players, statuses);
+    for (size_t i = 0; i < players.size(); ++i)
+        EXPECT_TRUE(statuses[i].Ok());
+
+    options.strikeRate = 1;
+    generatePlayer(options, 0, players[0]);
+    EXPECT_EQ(players[0].hits, Hits(12, AllPinsDown));
+    options.strikeRate = 0;
+    options.missRate = 1;
+    options.spareRate = 0;
+    generatePlayer(options, 0, players[0]);
+    EXPECT_EQ(players[0].hits, Hits(20, 0));
+
+    options.minNameLength = 0;
+    EXPECT_THROW(generatePlayer(options, 0, players[0]), std::runtime_error);
+}
+
+#endif //UNITTEST
@@ -0,0 +1,38 @@
+#ifndef GAME_GENERATOR_H
+#define GAME_GENERATOR_H
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class ThreadPool;
+
+///Distribution of generated games, rates are chances from 0 to 1
+struct GeneratorOptions
+{
+    GeneratorOptions();
+
+    uint64_t seed;
+    size_t playerCount;
+    double strikeRate;      ///first roll of frame knocks down all pins
+    double spareRate;       ///second roll knocks down the rest of pins
+    double missRate;        ///roll which isn't strike or spare knocks down no pins
+    size_t minNameLength;   ///name length is uniform in [minNameLength, maxNameLength]
+    size_t maxNameLength;
+    double invalidRate;     ///game is parsed but rejected by scoring: hit or frame is more than 10 pins,
+                            ///or strike or spare of 10th frame has no bonus hits
+};
+
+///Game of player with given index, depends only on options and index, so players are the same
+///for the same seed whatever threads generate them. Throws std::runtime_error on wrong options
+void generatePlayer(const GeneratorOptions& options, size_t index, PlayerHits& player);
+
+///Write options.playerCount players in text input format, chunks of players are generated by
+///pool threads and written in order. Throws std::runtime_error on wrong options or if file
+///can't be written
+void generateTextFile(const std::string& filename, const GeneratorOptions& options, ThreadPool& pool);
+///Same as above in binary hits format
+void generateBinaryFile(const std::string& filename, const GeneratorOptions& options, ThreadPool& pool);
+
+#endif //GAME_GENERATOR_H
@@ -1,5 +1,29 @@
 #include "input_parser.h"
+#include "mapped_file.h"
+#include "metrics.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <fstream>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOWLING_SSE2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define BOWLING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BOWLING_TARGET_AVX2
+#endif
 
 namespace //anonymous
 {
@@ -7,33 +31,705 @@ namespace //anonymous
     class InputParserImpl : public InputParser
     {
     public:
-        PlayersHits Parse(std::istream& input) override
+        void ForEachPlayer(std::istream& input, const PlayerHandler& handler) override
         {
-            PlayersHits result;
+            PlayerHits player;
             char buffer[256];
             while (input.getline(buffer, sizeof(buffer)))
             {
                 std::stringstream in(buffer);
                 std::string name;
                 in >> name;
-                name = name.substr(0, name.size() - 1);
-                std::vector<unsigned int> hits;
+                player.playerName = name.substr(0, name.size() - 1);
+                player.hits.clear();
                 while (!in.eof())
                 {
                     unsigned int hit;
                     in >> hit;
-                    hits.push_back(hit);
+                    player.hits.push_back(hit);
+                }
+
+                handler(player);
+            }
+        }
+    };
+
+    inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    inline bool IsDigit(char c)
+    {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    ///Malformed input line
+    class LineError : public std::runtime_error
+    {
+    public:
+        LineError(size_t i_lineNumber, const std::string& i_reason)
+            : std::runtime_error("Line " + std::to_string(i_lineNumber) + ": " + i_reason)
+            , lineNumber(i_lineNumber)
+            , reason(i_reason)
+        {
+        }
+
+        size_t lineNumber;
+        std::string reason;
+    };
+
+    ///Fast path of line tokenizing, selected by instruction set
+    struct Tokenizer
+    {
+        ///Find first space or tab in [pos, end), returns end if there is none
+        const char* (*FindSpace)(const char* pos, const char* end);
+        ///Convert as many "hit hit ..." tokens starting from pos as possible into hits.
+        ///Byte before pos must not be a digit. Returns position where scalar code has to continue
+        const char* (*TokenizeHits)(const char* pos, const char* end, Hits& hits);
+    };
+
+    const char* FindSpaceScalar(const char* pos, const char* end)
+    {
+        while (pos != end && !IsSpace(*pos))
+            ++pos;
+        return pos;
+    }
+
+    const char* TokenizeHitsScalar(const char* pos, const char* /*end*/, Hits& /*hits*/)
+    {
+        return pos;     //everything is done by scalar loop of the scanner
+    }
+
+#ifdef BOWLING_SSE2
+    inline unsigned int LowestBitIndex(uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    inline unsigned int HighestBitIndex(uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, mask);
+        return index;
+#else
+        return 31 - __builtin_clz(mask);
+#endif
+    }
+
+    ///Convert complete tokens of a classified block of width bytes at pos into hits.
+    ///Bit i of digits/spaces masks tells if pos[i] is a digit/space.
+    ///Returns count of consumed bytes, fallback is set if scalar code has to continue after them
+    inline size_t TokenizeBlock(const char* pos, uint64_t digits, uint64_t spaces, size_t width, Hits& hits, bool& fallback)
+    {
+        const uint64_t all = (uint64_t(1) << width) - 1;
+        if ((digits | spaces) != all)
+        {
+            fallback = true;    //unexpected character, let scalar code report it
+            return 0;
+        }
+
+        uint64_t starts = digits & ~(digits << 1);
+        size_t consumed = width;
+        if (digits & (uint64_t(1) << (width - 1)))
+        {
+            //last token may continue in the next block, leave it there
+            consumed = HighestBitIndex(static_cast<uint32_t>(starts));
+            if (consumed == 0)
+            {
+                fallback = true;
+                return 0;
+            }
+            starts &= (uint64_t(1) << consumed) - 1;
+        }
+
+        while (starts != 0)
+        {
+            const unsigned int i = LowestBitIndex(static_cast<uint32_t>(starts));
+            starts &= starts - 1;
+            unsigned int hit = pos[i] - '0';
+            if (digits & (uint64_t(1) << (i + 1)))
+            {
+                if (digits & (uint64_t(1) << (i + 2)))
+                {
+                    fallback = true;    //hits are at most two digits, longer values go to scalar code
+                    return i;
+                }
+                hit = hit * 10 + (pos[i + 1] - '0');    //"10"
+            }
+            hits.push_back(hit);
+        }
+        return consumed;
+    }
+
+    const char* FindSpaceSse2(const char* pos, const char* end)
+    {
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        while (end - pos >= 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)));
+            if (mask != 0)
+                return pos + LowestBitIndex(mask);
+            pos += 16;
+        }
+        return FindSpaceScalar(pos, end);
+    }
+
+    const char* TokenizeHitsSse2(const char* pos, const char* end, Hits& hits)
+    {
+        const __m128i beforeZero = _mm_set1_epi8('0' - 1);
+        const __m128i afterNine = _mm_set1_epi8('9' + 1);
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        bool fallback = false;
+        while (end - pos >= 16 && !fallback)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const uint32_t digits = _mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(block, beforeZero), _mm_cmplt_epi8(block, afterNine)));
+            const uint32_t spaces = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)));
+            pos += TokenizeBlock(pos, digits, spaces, 16, hits, fallback);
+        }
+        return pos;
+    }
+
+    BOWLING_TARGET_AVX2 const char* FindSpaceAvx2(const char* pos, const char* end)
+    {
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        while (end - pos >= 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+            const uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)));
+            if (mask != 0)
+                return pos + LowestBitIndex(mask);
+            pos += 32;
+        }
+        return FindSpaceSse2(pos, end);
+    }
+
+    BOWLING_TARGET_AVX2 const char* TokenizeHitsAvx2(const char* pos, const char* end, Hits& hits)
+    {
+        const __m256i beforeZero = _mm256_set1_epi8('0' - 1);
+        const __m256i afterNine = _mm256_set1_epi8('9' + 1);
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        bool fallback = false;
+        while (end - pos >= 32 && !fallback)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+            const __m256i digitBytes = _mm256_and_si256(_mm256_cmpgt_epi8(block, beforeZero), _mm256_cmpgt_epi8(afterNine, block));
+            const uint32_t digits = _mm256_movemask_epi8(digitBytes);
+            const uint32_t spaces = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)));
+            pos += TokenizeBlock(pos, digits, spaces, 32, hits, fallback);
+        }
+        return fallback ? pos : TokenizeHitsSse2(pos, end, hits);
+    }
+
+    bool CpuSupportsAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;   //OSXSAVE and YMM state
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif //BOWLING_SSE2
+
+    bool IsTokenizerSupported(TokenizerIsa isa)
+    {
+        switch (isa)
+        {
+        case TokenizerIsa::Scalar:
+            return true;
+#ifdef BOWLING_SSE2
+        case TokenizerIsa::Sse2:
+            return true;
+        case TokenizerIsa::Avx2:
+            return CpuSupportsAvx2();
+#endif
+        default:
+            return false;
+        }
+    }
+
+    Tokenizer GetTokenizer(TokenizerIsa isa)
+    {
+        if (!IsTokenizerSupported(isa))
+            throw std::runtime_error("Tokenizer instruction set is not supported by this CPU");
+        switch (isa)
+        {
+#ifdef BOWLING_SSE2
+        case TokenizerIsa::Sse2:
+            return { FindSpaceSse2, TokenizeHitsSse2 };
+        case TokenizerIsa::Avx2:
+            return { FindSpaceAvx2, TokenizeHitsAvx2 };
+#endif
+        default:
+            return { FindSpaceScalar, TokenizeHitsScalar };
+        }
+    }
+
+    ///Tokenizes "Name: hit hit ..." lines in place, without copying them out of the source buffer
+    class LineScanner
+    {
+    private:
+        const Tokenizer m_tokenizer;
+
+        static const char* SkipSpaces(const char* pos, const char* end)
+        {
+            while (pos != end && IsSpace(*pos))
+                ++pos;
+            return pos;
+        }
+
+    public:
+        ///Parse single line [begin, end) without line feed into player
+        void ParseLine(const char* begin, const char* end, PlayerHits& player) const
+        {
+            const char* pos = SkipSpaces(begin, end);
+            const char* nameEnd = m_tokenizer.FindSpace(pos, end);
+            //name is followed by ':'
+            const char* nameLast = (nameEnd != pos && nameEnd[-1] == ':') ? nameEnd - 1 : nameEnd;
+            player.playerName.assign(pos, nameLast);
+
+            player.hits.clear();
+            pos = SkipSpaces(m_tokenizer.TokenizeHits(nameEnd, end, player.hits), end);
+            while (pos != end)
+            {
+                const char* digitsBegin = pos;
+                unsigned int hit = 0;
+                while (pos != end && IsDigit(*pos))
+                {
+                    if (hit > (UINT_MAX - 9) / 10)
+                        throw std::runtime_error("Hit value is too big");
+                    hit = hit * 10 + (*pos - '0');
+                    ++pos;
+                }
+                if (pos == digitsBegin || (pos != end && !IsSpace(*pos)))
+                    throw std::runtime_error("Unexpected character in hit values");
+                player.hits.push_back(hit);
+                pos = SkipSpaces(pos, end);
+            }
+        }
+
+        explicit LineScanner(TokenizerIsa isa)
+            : m_tokenizer(GetTokenizer(isa))
+        {
+        }
+
+        ///Parse all lines of [begin, end) and hand them to handler, blank lines are skipped.
+        ///lineNumber is the number of lines before begin, returns it advanced past the last line
+        size_t ParseBuffer(const char* begin, const char* end, size_t lineNumber,
+            PlayerHits& player, const InputParser::PlayerHandler& handler) const
+        {
+            const size_t firstLineNumber = lineNumber;
+            const char* lineBegin = begin;
+            while (lineBegin != end)
+            {
+                ++lineNumber;
+                const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', end - lineBegin));
+                const char* next = lineEnd != nullptr ? lineEnd + 1 : end;
+                if (lineEnd == nullptr)
+                    lineEnd = end;
+                if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+                    --lineEnd;
+
+                if (SkipSpaces(lineBegin, lineEnd) != lineEnd)
+                {
+                    try
+                    {
+                        ParseLine(lineBegin, lineEnd, player);
+                    }
+                    catch (const std::runtime_error& e)
+                    {
+                        throw LineError(lineNumber, e.what());
+                    }
+                    handler(player);
+                }
+                lineBegin = next;
+            }
+            addMetric(MetricCounter::BytesParsed, end - begin);
+            addMetric(MetricCounter::LinesParsed, lineNumber - firstLineNumber);
+            return lineNumber;
+        }
+    };
+
+    ///Streams can't be mapped, so they are read by chunks of this size
+    const size_t StreamChunkSize = 64 * 1024;
+
+    ///Files smaller than this per thread are not worth splitting between threads
+    const size_t MinParallelChunkSize = 1024 * 1024;
+
+    class MappedInputParserImpl : public InputParser
+    {
+    private:
+        const size_t m_threadCount;
+        const LineScanner m_scanner;
+        ThreadPool* const m_pool;   ///runs chunks if set, otherwise every chunk gets own thread
+
+        ///Result of parsing one byte range of the file by worker thread
+        struct ChunkResult
+        {
+            PlayersHits players;
+            std::exception_ptr error;
+        };
+
+        ///Split [begin, end) into ranges ending at line boundaries, parse them in parallel
+        ///and hand out players in original line order
+        void ParseParallel(const char* begin, const char* end, size_t threadCount, const PlayerHandler& handler)
+        {
+            std::vector<const char*> bounds(threadCount + 1, end);
+            bounds[0] = begin;
+            const size_t size = end - begin;
+            for (size_t i = 1; i < threadCount; ++i)
+            {
+                const char* bound = std::max(bounds[i - 1], begin + size / threadCount * i);
+                const char* lineEnd = static_cast<const char*>(std::memchr(bound, '\n', end - bound));
+                bounds[i] = lineEnd != nullptr ? lineEnd + 1 : end;
+            }
+
+            std::vector<ChunkResult> chunks(threadCount);
+            auto parseChunk = [this, &chunks, &bounds](size_t i)
+            {
+                ChunkResult& chunk = chunks[i];
+                try
+                {
+                    PlayerHits player;
+                    m_scanner.ParseBuffer(bounds[i], bounds[i + 1], 0, player,
+                        [&chunk](PlayerHits& parsed) { chunk.players.push_back(std::move(parsed)); });
+                }
+                catch (...)
+                {
+                    chunk.error = std::current_exception();
                 }
+            };
+            if (m_pool != nullptr)
+            {
+                m_pool->ParallelFor(threadCount, 1, [&parseChunk](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                        parseChunk(i);
+                });
+            }
+            else
+            {
+                std::vector<std::thread> workers;
+                for (size_t i = 0; i < threadCount; ++i)
+                    workers.emplace_back(parseChunk, i);
+                for (std::thread& worker : workers)
+                    worker.join();
+            }
 
-                result.push_back({ name, hits });
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                if (chunks[i].error)
+                {
+                    //report the same line number as sequential parsing would
+                    try
+                    {
+                        std::rethrow_exception(chunks[i].error);
+                    }
+                    catch (const LineError& e)
+                    {
+                        const size_t linesBefore = std::count(begin, bounds[i], '\n');
+                        throw LineError(linesBefore + e.lineNumber, e.reason);
+                    }
+                }
+                for (PlayerHits& player : chunks[i].players)
+                    handler(player);
+                PlayersHits().swap(chunks[i].players);
             }
-            return result;
+        }
+
+    public:
+        MappedInputParserImpl(size_t threadCount, TokenizerIsa isa, ThreadPool* pool)
+            : m_threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+            , m_scanner(isa)
+            , m_pool(pool)
+        {
+        }
+
+        void ForEachPlayer(std::istream& input, const PlayerHandler& handler) override
+        {
+            PlayerHits player;
+            std::vector<char> buffer(StreamChunkSize);
+            size_t lineNumber = 0;
+            size_t carried = 0;     //size of incomplete last line kept at buffer start
+            while (input)
+            {
+                if (buffer.size() - carried < StreamChunkSize)
+                    buffer.resize(carried + StreamChunkSize);   //line is longer than chunk
+                input.read(buffer.data() + carried, buffer.size() - carried);
+                const size_t size = carried + static_cast<size_t>(input.gcount());
+
+                //carried part has no line feeds, so only the bytes just read are searched
+                size_t linesEnd = size;
+                while (linesEnd != carried && buffer[linesEnd - 1] != '\n')
+                    --linesEnd;
+                if (linesEnd == carried)
+                    linesEnd = 0;
+                if (!input)
+                    linesEnd = size;    //last line doesn't have to end with line feed
+                if (linesEnd == 0)
+                {
+                    carried = size;
+                    continue;
+                }
+
+                lineNumber = m_scanner.ParseBuffer(buffer.data(), buffer.data() + linesEnd, lineNumber, player, handler);
+                carried = size - linesEnd;
+                std::memmove(buffer.data(), buffer.data() + linesEnd, carried);
+            }
+        }
+
+        void ParseLine(const char* begin, const char* end, PlayerHits& player) override
+        {
+            m_scanner.ParseLine(begin, end, player);
+        }
+
+        void ForEachPlayerInFile(const std::string& filename, const PlayerHandler& handler) override
+        {
+            MappedFile file(filename);
+            const size_t threadCount = std::min(m_threadCount, file.Size() / MinParallelChunkSize);
+            if (threadCount > 1)
+            {
+                ParseParallel(file.Data(), file.Data() + file.Size(), threadCount, handler);
+                return;
+            }
+            PlayerHits player;
+            m_scanner.ParseBuffer(file.Data(), file.Data() + file.Size(), 0, player, handler);
         }
     };
 
 }   //namespace anonymous
 
+void InputParser::ForEachPlayerInFile(const std::string& filename, const PlayerHandler& handler)
+{
+    std::ifstream input(filename);
+    if (!input)
+        throw std::runtime_error("Can't open file " + filename);
+    ForEachPlayer(input, handler);
+}
+
+void InputParser::ParseLine(const char* begin, const char* end, PlayerHits& player)
+{
+    std::istringstream input(std::string(begin, end));
+    bool parsed = false;
+    ForEachPlayer(input, [&player, &parsed](PlayerHits& parsedPlayer)
+    {
+        player = std::move(parsedPlayer);
+        parsed = true;
+    });
+    if (!parsed)
+        throw std::runtime_error("Line has no player");
+}
+
+PlayersHits InputParser::Parse(std::istream& input)
+{
+    PlayersHits result;
+    ForEachPlayer(input, [&result](PlayerHits& player) { result.push_back(std::move(player)); });
+    return result;
+}
+
+PlayersHits InputParser::ParseFile(const std::string& filename)
+{
+    PlayersHits result;
+    ForEachPlayerInFile(filename, [&result](PlayerHits& player) { result.push_back(std::move(player)); });
+    return result;
+}
+
 InputParserPtr getInputParser()
 {
     return std::make_unique<InputParserImpl>();
 }
+
+TokenizerIsa getBestTokenizerIsa()
+{
+    static const TokenizerIsa best =
+        IsTokenizerSupported(TokenizerIsa::Avx2) ? TokenizerIsa::Avx2
+        : IsTokenizerSupported(TokenizerIsa::Sse2) ? TokenizerIsa::Sse2
+        : TokenizerIsa::Scalar;
+    return best;
+}
+
+InputParserPtr getMappedInputParser(size_t threadCount, TokenizerIsa isa)
+{
+    return std::make_unique<MappedInputParserImpl>(threadCount, isa, nullptr);
+}
+
+InputParserPtr getMappedInputParser(ThreadPool& pool, TokenizerIsa isa)
+{
+    return std::make_unique<MappedInputParserImpl>(pool.ThreadCount(), isa, &pool);
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+
+///Mapped parser gives the same players as stream parser on well-formed input
+TEST(inputParser, mappedMatchesStream)
+{
+    const std::string text =
+        "Lebowsky: 10 5 5 7 2 6 4 10 0 7 6 4 3 5 7 2 10 10 10\n"
+        "Sobchak: 5 5 7 1 8 2 3 5 8 2 10 0 6 5 5 6 1 0 10 5\n"
+        "Donny: 0 0 10 0 7 8 1 7 3 6 1 0 10 6 1 7 0 5 4";
+
+    std::istringstream streamInput(text);
+    const PlayersHits expected = InputParserImpl().Parse(streamInput);
+    std::istringstream mappedInput(text);
+    const PlayersHits result = MappedInputParserImpl(1, getBestTokenizerIsa(), nullptr).Parse(mappedInput);
+
+    ASSERT_EQ(expected.size(), result.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].playerName, result[i].playerName);
+        EXPECT_EQ(expected[i].hits, result[i].hits);
+    }
+}
+
+///Lines longer than stream parser buffer are not truncated, CRLF and blank lines are accepted
+TEST(inputParser, mappedLongLine)
+{
+    const size_t hitCount = 100000;     //line spans several read chunks
+    std::string text = "Walter:";
+    for (size_t i = 0; i < hitCount; ++i)
+        text += " 10";
+    text += "\r\n\r\nDonny: 1 2\r\n";
+
+    std::istringstream input(text);
+    const PlayersHits result = MappedInputParserImpl(1, getBestTokenizerIsa(), nullptr).Parse(input);
+
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].playerName, "Walter");
+    EXPECT_EQ(result[0].hits, Hits(hitCount, 10));
+    EXPECT_EQ(result[1].playerName, "Donny");
+    EXPECT_EQ(result[1].hits, Hits({ 1, 2 }));
+}
+
+///Players are streamed one by one from input larger than one read chunk
+TEST(inputParser, mappedStreamsAcrossChunks)
+{
+    std::string text;
+    for (size_t i = 0; i < 20000; ++i)
+        text += "Player" + std::to_string(i) + ": 10 10 10 10 10 10 10 10 10 10 10 10\n";
+
+    std::istringstream input(text);
+    size_t count = 0;
+    MappedInputParserImpl(1, getBestTokenizerIsa(), nullptr).ForEachPlayer(input, [&count](PlayerHits& player)
+    {
+        EXPECT_EQ(player.playerName, "Player" + std::to_string(count));
+        EXPECT_EQ(player.hits, Hits(12, 10));
+        ++count;
+    });
+    EXPECT_EQ(count, 20000);
+}
+
+///Multi-threaded parsing of a large file gives the same players and errors as single-threaded one
+TEST(inputParser, mappedParallelMatchesSequential)
+{
+    const std::string filename = "input_parser_test.tmp";
+    {
+        std::ofstream out(filename, std::ios::binary);
+        for (size_t i = 0; i < 100000; ++i)
+            out << "Player" << i << ": " << i % 11 << " 0 10 5 5 7 2 6 4 10 0 7 6 4 3 5 7 2\n";
+    }
+
+    const PlayersHits expected = MappedInputParserImpl(1, getBestTokenizerIsa(), nullptr).ParseFile(filename);
+    ThreadPool pool(4);
+    ASSERT_EQ(expected.size(), 100000);
+    for (const PlayersHits& result : { MappedInputParserImpl(4, getBestTokenizerIsa(), nullptr).ParseFile(filename),
+        getMappedInputParser(pool)->ParseFile(filename) })
+    {
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].playerName, result[i].playerName);
+            EXPECT_EQ(expected[i].hits, result[i].hits);
+        }
+    }
+
+    {
+        std::ofstream out(filename, std::ios::app | std::ios::binary);
+        out << "Broken: 1 -1\n";
+    }
+    try
+    {
+        MappedInputParserImpl(4, getBestTokenizerIsa(), nullptr).ParseFile(filename);
+        FAIL();
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Line 100001: Unexpected character in hit values");
+    }
+    std::remove(filename.c_str());
+}
+
+///Vectorized tokenizers give the same players and errors as scalar one, tokens cross block bounds
+TEST(inputParser, tokenizersMatchScalar)
+{
+    std::string text;
+    unsigned int seed = 1;
+    auto next = [&seed](unsigned int range) { seed = seed * 1103515245 + 12345; return (seed >> 16) % range; };
+    for (size_t line = 0; line < 2000; ++line)
+    {
+        text += std::string(next(3), ' ') + "Player" + std::string(next(40), 'x') + ":";
+        for (size_t i = next(40); i > 0; --i)
+        {
+            text += std::string(1 + next(3), next(4) == 0 ? '\t' : ' ');
+            text += std::to_string(next(10) == 0 ? next(100000) : next(11));
+        }
+        text += next(5) == 0 ? "\r\n" : "\n";
+    }
+
+    for (TokenizerIsa isa : { TokenizerIsa::Sse2, TokenizerIsa::Avx2 })
+    {
+        if (!IsTokenizerSupported(isa))
+            continue;
+        std::istringstream scalarInput(text);
+        const PlayersHits expected = MappedInputParserImpl(1, TokenizerIsa::Scalar, nullptr).Parse(scalarInput);
+        std::istringstream input(text);
+        const PlayersHits result = MappedInputParserImpl(1, isa, nullptr).Parse(input);
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].playerName, result[i].playerName);
+            EXPECT_EQ(expected[i].hits, result[i].hits);
+        }
+
+        std::istringstream badInput("Walter: 10 10 10 10 10 10 10 10 10 10 1x 10 10 10 10 10 10\n");
+        EXPECT_THROW(MappedInputParserImpl(1, isa, nullptr).Parse(badInput), std::runtime_error);
+    }
+}
+
+///Malformed hit value is reported with its line number
+TEST(inputParser, mappedMalformedLine)
+{
+    std::istringstream input("Walter: 1 2\nDonny: 1 x\n");
+    try
+    {
+        MappedInputParserImpl(1, getBestTokenizerIsa(), nullptr).Parse(input);
+        FAIL();
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Line 2: Unexpected character in hit values");
+    }
+}
+
+#endif
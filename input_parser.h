@@ -2,16 +2,56 @@
 #define INPUT_PARSER_H
 
 #include "types.h"
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <string>
 
 class InputParser
 {
 public:
-    virtual PlayersHits Parse(std::istream& input) = 0;
+    ///Receives players one by one. The record is reused for the next player, move from it to keep it
+    typedef std::function<void(PlayerHits& player)> PlayerHandler;
+
+    virtual ~InputParser() {}
+
+    ///Parse input and hand out every player as soon as its line is read, in constant memory
+    virtual void ForEachPlayer(std::istream& input, const PlayerHandler& handler) = 0;
+    ///Same as ForEachPlayer for input file, throws std::runtime_error if file can't be read
+    virtual void ForEachPlayerInFile(const std::string& filename, const PlayerHandler& handler);
+
+    ///Parse single line [begin, end) without line feed into player, throws std::runtime_error
+    ///if it is malformed
+    virtual void ParseLine(const char* begin, const char* end, PlayerHits& player);
+
+    ///Parse whole input into memory
+    PlayersHits Parse(std::istream& input);
+    ///Parse whole input file into memory, throws std::runtime_error if file can't be read
+    PlayersHits ParseFile(const std::string& filename);
 };
 
 typedef std::unique_ptr<InputParser> InputParserPtr;
 InputParserPtr getInputParser();
 
+///Instruction set used to tokenize lines
+enum class TokenizerIsa
+{
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+///Fastest instruction set supported by this CPU
+TokenizerIsa getBestTokenizerIsa();
+
+///Parser which maps input file into memory and tokenizes it in place.
+///Has no line length limit, throws std::runtime_error on malformed line.
+///Large files are split between threadCount threads (0 - one per core), players keep file order.
+///Throws std::runtime_error if isa isn't supported by this CPU
+InputParserPtr getMappedInputParser(size_t threadCount = 1, TokenizerIsa isa = getBestTokenizerIsa());
+
+class ThreadPool;
+///Same as above, large files are split between threads of pool
+InputParserPtr getMappedInputParser(ThreadPool& pool, TokenizerIsa isa = getBestTokenizerIsa());
+
 #endif //INPUT_PARSER_H
@@ -0,0 +1,293 @@
+#include "live_scoreboard.h"
+#include "metrics.h"
+#include <algorithm>
+
+namespace //anonymous
+{
+    ///Widths of table cells, the same as streaming table has
+    const size_t FrameCellWidth = 3;
+    const size_t TenFrameCellWidth = MaxHitsPerFrame * 2 - 1;
+    const size_t TotalCellWidth = 3;
+
+    ///Lines of player rows: delimiter, hits and results
+    const size_t LinesPerRow = 3;
+
+    size_t DelimiterLine(size_t row)
+    {
+        return 1 + LinesPerRow * row;
+    }
+
+}   //namespace anonymous
+
+LiveScoreboard::LiveScoreboard(std::ostream& out, size_t nameWidth, std::chrono::milliseconds refreshInterval)
+    : m_out(out)
+    , m_nameWidth(nameWidth)
+    , m_refreshInterval(refreshInterval)
+    , m_cellColumn(CellCount)
+    , m_cellWidth(CellCount)
+    , m_shownRows(0)
+    , m_cleared(false)
+{
+    m_cellColumn[0] = 2;
+    m_cellWidth[0] = nameWidth;
+    size_t column = 2 + nameWidth + 1;
+    for (size_t i = 0; i < FramesPerGame; ++i)
+    {
+        const size_t width = i == FramesPerGame - 1 ? TenFrameCellWidth : FrameCellWidth;
+        m_cellColumn[1 + 2 * i] = m_cellColumn[2 + 2 * i] = column;
+        m_cellWidth[1 + 2 * i] = m_cellWidth[2 + 2 * i] = width;
+        column += width + 1;
+    }
+    m_cellColumn[CellCount - 1] = column;
+    m_cellWidth[CellCount - 1] = TotalCellWidth;
+}
+
+void LiveScoreboard::FormatCells(const PlayerTable& player, std::vector<std::string>& cells) const
+{
+    cells.resize(CellCount);
+    cells[0] = player.playerName;
+    for (size_t i = 0; i < FramesPerGame; ++i)
+    {
+        const Frame& frame = player.frames[i];
+        std::string& hits = cells[1 + 2 * i];
+        hits.clear();
+        for (char symbol : frame.hit)
+        {
+            if (!hits.empty())
+                hits += ' ';
+            hits += symbol;
+        }
+        //frames without rolls have no result yet
+        cells[2 + 2 * i] = frame.hit.empty() ? std::string() : std::to_string(frame.result);
+    }
+    cells[CellCount - 1] = std::to_string(player.total);
+}
+
+void LiveScoreboard::AppendCursor(size_t line, size_t column)
+{
+    m_buffer += "\x1b[";
+    m_buffer += std::to_string(line);
+    m_buffer += ';';
+    m_buffer += std::to_string(column);
+    m_buffer += 'H';
+}
+
+///Text is left aligned and cut to cell width, the rest of cell is cleared
+void LiveScoreboard::AppendCell(size_t row, size_t cell, const std::string& text)
+{
+    //name and hits are on the first line of row, results and total on the second one
+    const bool hitsLine = cell == 0 || (cell % 2 == 1 && cell != CellCount - 1);
+    AppendCursor(DelimiterLine(row) + (hitsLine ? 1 : 2), m_cellColumn[cell]);
+    const size_t width = m_cellWidth[cell];
+    m_buffer.append(text, 0, width);
+    if (text.size() < width)
+        m_buffer.append(width - text.size(), ' ');
+}
+
+void LiveScoreboard::AppendBorders(size_t line)
+{
+    AppendCursor(line, 1);
+    m_buffer += '|';
+    for (size_t cell = 0; cell < CellCount; cell += cell == 0 ? 1 : 2)
+    {
+        m_buffer.append(m_cellWidth[cell], ' ');
+        m_buffer += '|';
+    }
+}
+
+void LiveScoreboard::AppendDelimiter(size_t line)
+{
+    AppendCursor(line, 1);
+    m_buffer.append(m_cellColumn[CellCount - 1] + TotalCellWidth, '-');
+}
+
+void LiveScoreboard::Update(size_t playerIndex, const PlayerTable& player)
+{
+    if (playerIndex >= m_rows.size())
+        m_rows.resize(playerIndex + 1, Row{ {}, {}, false });
+    Row& row = m_rows[playerIndex];
+    FormatCells(player, row.pending);
+    if (!row.dirty)
+    {
+        row.dirty = true;
+        m_dirtyRows.push_back(playerIndex);
+    }
+}
+
+bool LiveScoreboard::Refresh()
+{
+    if (m_dirtyRows.empty() && m_shownRows == m_rows.size())
+        return false;
+    const auto now = std::chrono::steady_clock::now();
+    if (m_cleared && now - m_lastDraw < m_refreshInterval)
+        return false;
+    Draw();
+    m_lastDraw = now;
+    return true;
+}
+
+void LiveScoreboard::Flush()
+{
+    if (!m_dirtyRows.empty() || m_shownRows != m_rows.size())
+    {
+        Draw();
+        m_lastDraw = std::chrono::steady_clock::now();
+    }
+}
+
+void LiveScoreboard::Render(const PlayersTable& table)
+{
+    for (size_t i = 0; i < table.size(); ++i)
+        Update(i, table[i]);
+    Refresh();
+}
+
+void LiveScoreboard::Draw()
+{
+    m_buffer.clear();
+    if (!m_cleared)
+    {
+        m_buffer += "\x1b[2J";
+        m_cleared = true;
+    }
+
+    //new rows get borders and empty cells, their content is drawn as a change below
+    for (size_t row = m_shownRows; row < m_rows.size(); ++row)
+    {
+        AppendDelimiter(DelimiterLine(row));
+        AppendBorders(DelimiterLine(row) + 1);
+        AppendBorders(DelimiterLine(row) + 2);
+        m_rows[row].shown.assign(CellCount, std::string());
+    }
+    if (m_shownRows != m_rows.size())
+    {
+        AppendDelimiter(DelimiterLine(m_rows.size()));
+        m_shownRows = m_rows.size();
+    }
+
+    for (size_t index : m_dirtyRows)
+    {
+        Row& row = m_rows[index];
+        for (size_t cell = 0; cell < CellCount; ++cell)
+        {
+            if (row.pending[cell] != row.shown[cell])
+            {
+                AppendCell(index, cell, row.pending[cell]);
+                row.shown[cell] = row.pending[cell];
+            }
+        }
+        row.dirty = false;
+    }
+    m_dirtyRows.clear();
+
+    //cursor is left under the table
+    AppendCursor(DelimiterLine(m_rows.size()) + 1, 1);
+    m_out.write(m_buffer.data(), m_buffer.size());
+    addMetric(MetricCounter::BytesRendered, m_buffer.size());
+    m_out.flush();
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include "bowling_machine.h"
+#include <sstream>
+
+namespace //anonymous
+{
+    ///Apply ANSI output of scoreboard to screen of lines
+    std::vector<std::string> ApplyToScreen(const std::string& output, std::vector<std::string> screen)
+    {
+        size_t line = 0;
+        size_t column = 0;
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+            if (output.compare(i, 4, "\x1b[2J") == 0)
+            {
+                screen.clear();
+                i += 3;
+            }
+            else if (output[i] == '\x1b')
+            {
+                const size_t end = output.find('H', i);
+                const size_t separator = output.find(';', i);
+                line = std::stoul(output.substr(i + 2, separator - i - 2)) - 1;
+                column = std::stoul(output.substr(separator + 1, end - separator - 1)) - 1;
+                i = end;
+            }
+            else
+            {
+                if (screen.size() <= line)
+                    screen.resize(line + 1);
+                if (screen[line].size() <= column)
+                    screen[line].resize(column + 1, ' ');
+                screen[line][column++] = output[i];
+            }
+        }
+        return screen;
+    }
+}   //namespace anonymous
+
+///Screen shows the same table as streaming renderer, and the next roll redraws only two cells
+TEST(liveScoreboard, drawsOnlyChanges)
+{
+    LiveGamePtr dude = getLiveGame("Dude");
+    LiveGamePtr walter = getLiveGame("Walter");
+    for (unsigned int pins : { 10, 7, 3, 9, 0 })
+        dude->AddRoll(pins);
+    walter->AddRoll(8);
+
+    std::ostringstream out;
+    LiveScoreboard scoreboard(out, 6, std::chrono::milliseconds(0));
+    scoreboard.Update(0, dude->Table());
+    scoreboard.Update(1, walter->Table());
+    EXPECT_TRUE(scoreboard.Refresh());
+    std::vector<std::string> screen = ApplyToScreen(out.str(), {});
+    const std::vector<std::string> expected =
+    {
+        "------------------------------------------------------",
+        "|Dude  |x  |7 /|9 -|   |   |   |   |   |   |     |   |",
+        "|      |20 |19 |9  |   |   |   |   |   |   |     |48 |",
+        "------------------------------------------------------",
+        "|Walter|8  |   |   |   |   |   |   |   |   |     |   |",
+        "|      |8  |   |   |   |   |   |   |   |   |     |8  |",
+        "------------------------------------------------------",
+    };
+    EXPECT_EQ(screen, expected);
+
+    out.str("");
+    walter->AddRoll(2);
+    scoreboard.Update(1, walter->Table());
+    scoreboard.Update(0, dude->Table());    //unchanged player isn't redrawn
+    EXPECT_TRUE(scoreboard.Refresh());
+    EXPECT_EQ(out.str(), "\x1b[5;9H8 /\x1b[6;9H10 \x1b[6;51H10 \x1b[8;1H");
+    screen = ApplyToScreen(out.str(), screen);
+    EXPECT_EQ(screen[4], "|Walter|8 /|   |   |   |   |   |   |   |   |     |   |");
+    EXPECT_FALSE(scoreboard.Refresh());
+}
+
+///Updates within refresh interval are drawn together
+TEST(liveScoreboard, coalescesUpdates)
+{
+    LiveGamePtr dude = getLiveGame("Dude");
+    std::ostringstream out;
+    LiveScoreboard scoreboard(out, 4, std::chrono::hours(1));
+    scoreboard.Update(0, dude->Table());
+    EXPECT_TRUE(scoreboard.Refresh());      //first drawing isn't delayed
+    std::vector<std::string> screen = ApplyToScreen(out.str(), {});
+
+    out.str("");
+    for (unsigned int pins : { 1, 2, 3, 4 })
+    {
+        dude->AddRoll(pins);
+        scoreboard.Update(0, dude->Table());
+        EXPECT_FALSE(scoreboard.Refresh());
+    }
+    EXPECT_EQ(out.str(), "");
+    scoreboard.Flush();
+    screen = ApplyToScreen(out.str(), screen);
+    EXPECT_EQ(screen[1], "|Dude|1 2|3 4|   |   |   |   |   |   |   |     |   |");
+    EXPECT_EQ(screen[2], "|    |3  |7  |   |   |   |   |   |   |   |     |10 |");
+}
+
+#endif
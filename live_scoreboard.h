@@ -0,0 +1,65 @@
+#ifndef LIVE_SCOREBOARD_H
+#define LIVE_SCOREBOARD_H
+
+#include "result_renderer.h"
+#include "types.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+///Terminal scoreboard of games in progress. Keeps cells drawn last time and redraws only the
+///changed ones with ANSI cursor positioning, so output per update follows the change and not
+///the table size. Updates coming faster than refresh interval are drawn together by one refresh.
+///Rows have the look of streaming table: names are cut or padded to nameWidth
+class LiveScoreboard : public Renderer
+{
+public:
+    LiveScoreboard(std::ostream& out, size_t nameWidth, std::chrono::milliseconds refreshInterval);
+
+    ///Set player state, it is shown by the next refresh. Players are added as rows when their
+    ///index is met first time
+    void Update(size_t playerIndex, const PlayerTable& player);
+
+    ///Draw pending changes unless previous drawing was less than refresh interval ago.
+    ///Returns true if changes were drawn
+    bool Refresh();
+
+    ///Draw pending changes now
+    void Flush();
+
+    ///Update all players of the table and refresh
+    void Render(const PlayersTable& table) override;
+
+private:
+    ///Name, hits and result of every frame, total
+    static const size_t CellCount = 2 + 2 * FramesPerGame;
+
+    struct Row
+    {
+        std::vector<std::string> shown;     ///cells on terminal, empty for a new row
+        std::vector<std::string> pending;
+        bool dirty;
+    };
+
+    void FormatCells(const PlayerTable& player, std::vector<std::string>& cells) const;
+    void AppendCursor(size_t line, size_t column);
+    void AppendCell(size_t line, size_t cell, const std::string& text);
+    void AppendBorders(size_t line);
+    void AppendDelimiter(size_t line);
+    void Draw();
+
+    std::ostream& m_out;
+    const size_t m_nameWidth;
+    const std::chrono::milliseconds m_refreshInterval;
+    std::chrono::steady_clock::time_point m_lastDraw;
+    std::vector<Row> m_rows;
+    std::vector<size_t> m_dirtyRows;
+    std::vector<size_t> m_cellColumn;   ///first terminal column of every cell, 1-based
+    std::vector<size_t> m_cellWidth;
+    size_t m_shownRows;                 ///rows with borders drawn
+    bool m_cleared;
+    std::string m_buffer;
+};
+
+#endif //LIVE_SCOREBOARD_H
@@ -1,37 +1,441 @@
 #include "input_parser.h"
+#include "batch_runner.h"
+#include "binary_hits.h"
 #include "bowling_machine.h"
+#include "game_generator.h"
+#include "live_scoreboard.h"
+#include "metrics.h"
+#include "pipeline.h"
 #include "result_renderer.h"
-#include <iostream>
+#include "score_cache.h"
+#include "scoring_server.h"
+#include "thread_pool.h"
 #include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace //anonymous
+{
+    ///Name width of fixed-width tables if --name-width isn't given
+    const size_t DefaultNameWidth = 16;
+
+    ///Writes metrics into std::cerr when the run is over, so they don't mix with results on std::cout
+    class MetricsDump
+    {
+    private:
+        std::string m_format;
+
+    public:
+        void SetFormat(const std::string& format)
+        {
+            if (format != "json" && format != "prometheus")
+                throw std::runtime_error("Unknown metrics format " + format);
+            m_format = format;
+            enableMetrics(true);
+        }
+
+        ~MetricsDump()
+        {
+            if (m_format == "json")
+                std::cerr << formatMetricsJson(getMetrics()) << "\n";
+            else if (m_format == "prometheus")
+                std::cerr << formatMetricsPrometheus(getMetrics());
+        }
+    };
+}   //namespace anonymous
 
 int main(int argc, char* argv[])
 {
+    //outlives the thread pool, so counters of pool threads are merged when it is dumped
+    MetricsDump metricsDump;
     try
     {
-        if (argc < 2)
+        std::vector<std::string> fileNames;
+        size_t threadCount = 1;
+        std::string conversion;
+        std::string engine = "scalar";
+        std::string rules = "tenpin";
+        size_t cacheMegabytes = 0;
+        std::string format = "table";
+        size_t nameWidth = 0;
+        bool leaderboard = false;
+        size_t topCount = 0;
+        RankStyle rankStyle = RankStyle::Competition;
+        bool live = false;
+        bool pipeline = false;
+        bool batch = false;
+        size_t batchSize = 4096;
+        size_t queueDepth = 4;
+        size_t liveRefreshMs = 0;
+        std::string serveSocket;
+        std::string clientSocket;
+        std::string loadTestSocket;
+        size_t connections = 8;
+        size_t rounds = 10;
+        bool generate = false;
+        GeneratorOptions generatorOptions;
+        for (int i = 1; i < argc; ++i)
         {
-            std::cout << "Usage: bowling.exe input.txt [output.txt]";
+            const std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc)
+                threadCount = std::stoul(argv[++i]);
+            else if (arg == "--engine" && i + 1 < argc)
+                engine = argv[++i];
+            else if (arg == "--rules" && i + 1 < argc)
+                rules = argv[++i];
+            else if (arg == "--cache" && i + 1 < argc)
+                cacheMegabytes = std::stoul(argv[++i]);
+            else if (arg == "--format" && i + 1 < argc)
+                format = argv[++i];
+            else if (arg == "--name-width" && i + 1 < argc)
+                nameWidth = std::stoul(argv[++i]);
+            else if (arg == "--pipeline")
+                pipeline = true;
+            else if (arg == "--batch")
+                batch = true;
+            else if (arg == "--batch-size" && i + 1 < argc)
+                batchSize = std::stoul(argv[++i]);
+            else if (arg == "--queue-depth" && i + 1 < argc)
+                queueDepth = std::stoul(argv[++i]);
+            else if (arg == "--serve" && i + 1 < argc)
+                serveSocket = argv[++i];
+            else if (arg == "--client" && i + 1 < argc)
+                clientSocket = argv[++i];
+            else if (arg == "--load-test" && i + 1 < argc)
+                loadTestSocket = argv[++i];
+            else if (arg == "--connections" && i + 1 < argc)
+                connections = std::stoul(argv[++i]);
+            else if (arg == "--rounds" && i + 1 < argc)
+                rounds = std::stoul(argv[++i]);
+            else if (arg == "--live" && i + 1 < argc)
+            {
+                live = true;
+                liveRefreshMs = std::stoul(argv[++i]);
+            }
+            else if (arg == "--top" && i + 1 < argc)
+            {
+                leaderboard = true;
+                topCount = std::stoul(argv[++i]);
+            }
+            else if (arg == "--rank" && i + 1 < argc)
+            {
+                const std::string style = argv[++i];
+                if (style != "dense" && style != "competition")
+                    throw std::runtime_error("Unknown rank style " + style);
+                rankStyle = style == "dense" ? RankStyle::Dense : RankStyle::Competition;
+            }
+            else if (arg == "--metrics" && i + 1 < argc)
+                metricsDump.SetFormat(argv[++i]);
+            else if (arg == "--generate")
+                generate = true;
+            else if (arg == "--seed" && i + 1 < argc)
+                generatorOptions.seed = std::stoull(argv[++i]);
+            else if (arg == "--players" && i + 1 < argc)
+                generatorOptions.playerCount = std::stoul(argv[++i]);
+            else if (arg == "--strike-rate" && i + 1 < argc)
+                generatorOptions.strikeRate = std::stod(argv[++i]);
+            else if (arg == "--spare-rate" && i + 1 < argc)
+                generatorOptions.spareRate = std::stod(argv[++i]);
+            else if (arg == "--miss-rate" && i + 1 < argc)
+                generatorOptions.missRate = std::stod(argv[++i]);
+            else if (arg == "--min-name-length" && i + 1 < argc)
+                generatorOptions.minNameLength = std::stoul(argv[++i]);
+            else if (arg == "--max-name-length" && i + 1 < argc)
+                generatorOptions.maxNameLength = std::stoul(argv[++i]);
+            else if (arg == "--invalid-rate" && i + 1 < argc)
+                generatorOptions.invalidRate = std::stod(argv[++i]);
+            else if (arg == "--to-binary" || arg == "--to-text")
+                conversion = arg;
+            else
+                fileNames.push_back(arg);
         }
-        std::string inputFileName = argv[1];
+
+        if ((fileNames.empty() && serveSocket == "") || (conversion != "" && fileNames.size() != 2) || (generate && fileNames.size() != 1))
+        {
+            std::cout << "Usage: bowling.exe input.txt [output.txt] [--threads N (0 - one per core)] [--engine scalar|batch|table]\n"
+                << "       [--rules tenpin|candlepin|ninepin] [--cache MB] [--format table|csv|jsonl|binary (of output.txt)]\n"
+                << "       [--name-width N (streaming table with fixed widths)]\n"
+                << "       [--top K (leaderboard of K best players, 0 - all)] [--rank dense|competition]\n"
+                << "       [--pipeline (concurrent parse, score and render stages)] [--batch-size N] [--queue-depth N]\n"
+                << "       [--live MS (replay games roll by roll on live scoreboard refreshed at most every MS)]\n"
+                << "       [--metrics json|prometheus (counters and stage times written to stderr on exit)]\n"
+                << "       bowling.exe --batch input_directory|\"glob\" [output_directory] [--threads N] [--format ...]\n"
+                << "       bowling.exe --serve socket [--threads N] [--engine scalar|batch|table] [--cache MB]\n"
+                << "       bowling.exe --client socket input.txt\n"
+                << "       bowling.exe --load-test socket input.txt [--connections N] [--rounds N]\n"
+                << "       bowling.exe --generate output.txt --players N [--seed N] [--threads N] [--format table|binary (text or binary hits)]\n"
+                << "       [--strike-rate P] [--spare-rate P] [--miss-rate P] [--invalid-rate P (0..1)] [--min-name-length N] [--max-name-length N]\n"
+                << "       bowling.exe --to-binary input.txt output.bin\n"
+                << "       bowling.exe --to-text input.bin output.txt";
+            return 1;
+        }
+        if (conversion == "--to-binary")
+        {
+            convertTextToBinary(fileNames[0], fileNames[1]);
+            return 0;
+        }
+        if (conversion == "--to-text")
+        {
+            convertBinaryToText(fileNames[0], fileNames[1]);
+            return 0;
+        }
+        if (generate)
+        {
+            //output depends only on options, not on thread count
+            ThreadPool generatorPool(threadCount);
+            if (format == "binary")
+                generateBinaryFile(fileNames[0], generatorOptions, generatorPool);
+            else if (format == "table")
+                generateTextFile(fileNames[0], generatorOptions, generatorPool);
+            else
+                throw std::runtime_error("Generator writes text or binary hits, not " + format);
+            return 0;
+        }
+        if (leaderboard && format != "table")
+            throw std::runtime_error("Leaderboard is rendered only as table, not " + format);
+        std::string inputFileName = fileNames.empty() ? std::string() : fileNames[0];
         std::string outputFileName;
-        if (argc > 2)
+        if (fileNames.size() > 1)
+        {
+            outputFileName = fileNames[1];
+        }
+
+        if (clientSocket != "")
+        {
+            std::ifstream input(inputFileName, std::ios::binary);
+            if (!input)
+                throw std::runtime_error("Can't open file " + inputFileName);
+            runScoringClient(clientSocket, input, std::cout);
+            return 0;
+        }
+        if (loadTestSocket != "")
+        {
+            std::ifstream input(inputFileName, std::ios::binary);
+            if (!input)
+                throw std::runtime_error("Can't open file " + inputFileName);
+            const std::string request((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+            const LoadTestStats stats = runScoringLoadTest(loadTestSocket, request, connections, rounds);
+            std::cout << stats.players << " players in " << stats.seconds << " s, " << stats.players / stats.seconds
+                << " players/s, round latency median " << stats.medianLatencyMs << " ms, max " << stats.maxLatencyMs << " ms\n";
+            return 0;
+        }
+
+        //one pool is shared by parsing and scoring stages
+        ThreadPool pool(threadCount);
+        const bool parallel = pool.ThreadCount() > 1;
+
+        ScoreCache cache(cacheMegabytes * 1024 * 1024);
+        BowlingMachinePtr machine;
+        if (cacheMegabytes != 0)
+        {
+            if (engine != "scalar" || rules != "tenpin")
+                throw std::runtime_error("Cache is supported only by scalar engine with tenpin rules");
+            machine = parallel ? getParallelCachingBowlingMachine(pool, cache) : getCachingBowlingMachine(cache);
+        }
+        else if (rules != "tenpin")
         {
-            outputFileName = argv[2];
+            if (engine != "scalar" || parallel)
+                throw std::runtime_error("Rules " + rules + " are supported only by single-threaded scalar engine");
+            machine = getBowlingMachine(rules);
         }
+        else if (engine == "scalar")
+            machine = parallel ? getParallelBowlingMachine(pool) : getBowlingMachine();
+        else if (engine == "batch")
+            machine = parallel ? getParallelBatchBowlingMachine(pool) : getBatchBowlingMachine();
+        else if (engine == "table")
+            machine = parallel ? getParallelTableBowlingMachine(pool) : getTableBowlingMachine();
+        else
+            throw std::runtime_error("Unknown scoring engine " + engine);
 
-        std::ifstream input(inputFileName);
-        const auto& playersHits = getInputParser()->Parse(input);
-        input.close();
-        const auto& playersResults = getBowlingMachine()->CalcPlayersTable(playersHits);
+        if (serveSocket != "")
+        {
+            //parser and machine are reused by all requests
+            InputParserPtr lineParser = getMappedInputParser(1);
+            ScoringServerPtr server = getScoringServer(serveSocket, *lineParser, *machine);
+            server->Run();
+            return 0;
+        }
+
+        if (batch)
+        {
+            //files are spread between pool threads, every file is parsed and scored by one thread
+            InputParserPtr fileParser = getMappedInputParser(1);
+            BowlingMachinePtr fileMachine = cacheMegabytes != 0 ? getCachingBowlingMachine(cache)
+                : rules != "tenpin" ? getBowlingMachine(rules)
+                : engine == "batch" ? getBatchBowlingMachine()
+                : engine == "table" ? getTableBowlingMachine()
+                : getBowlingMachine();
+            RendererFactory rendererFactory;
+            std::string outputSuffix;
+            if (format == "table")
+            {
+                if (nameWidth != 0 && rules != "tenpin")
+                    throw std::runtime_error("Tables of fixed width fit only tenpin frames");
+                outputSuffix = ".out";
+                rendererFactory = [nameWidth](const std::string& outputFile)
+                {
+                    return nameWidth != 0 ? RendererPtr(getStreamingFileRenderer(outputFile, nameWidth)) : getFileRenderer(outputFile);
+                };
+            }
+            else if (format == "csv")
+            {
+                outputSuffix = ".csv";
+                rendererFactory = [](const std::string& outputFile) -> RendererPtr { return getCsvRenderer(outputFile); };
+            }
+            else if (format == "jsonl")
+            {
+                outputSuffix = ".jsonl";
+                rendererFactory = [](const std::string& outputFile) -> RendererPtr { return getJsonLinesRenderer(outputFile); };
+            }
+            else if (format == "binary")
+            {
+                outputSuffix = ".bin";
+                rendererFactory = [](const std::string& outputFile) -> RendererPtr { return getBinaryRenderer(outputFile); };
+            }
+            else
+                throw std::runtime_error("Unknown output format " + format);
+
+            const std::vector<BatchFileResult> results = runBatch(listInputFiles(inputFileName),
+                outputFileName != "" ? outputFileName : ".", outputSuffix, *fileParser, *fileMachine, rendererFactory, pool);
+            size_t failed = 0;
+            for (const BatchFileResult& result : results)
+            {
+                if (result.error != "")
+                {
+                    std::cout << "File " << result.inputFile << " failed: " << result.error << "\n";
+                    ++failed;
+                }
+                else if (result.skipped != 0)
+                {
+                    std::cout << "File " << result.inputFile << ": " << result.skipped << " players are skipped\n";
+                }
+            }
+            std::cout << results.size() - failed << " files are done, " << failed << " failed\n";
+            return failed == 0 ? 0 : 1;
+        }
+
+        if (pipeline)
+        {
+            if (leaderboard || live)
+                throw std::runtime_error("Pipeline renders players as they come, it can't rank them or replay games");
+            if (rules != "tenpin")
+                throw std::runtime_error("Pipeline renders tables of fixed width, they fit only tenpin frames");
+            //players are parsed by one thread in file order, scoring batches uses the pool
+            InputParserPtr streamParser = isBinaryHitsFile(inputFileName) ? getBinaryInputParser() : getMappedInputParser(1);
+            const size_t streamNameWidth = nameWidth != 0 ? nameWidth : DefaultNameWidth;
+            std::vector<RecordRendererPtr> renderers;
+            renderers.push_back(getStreamingConsoleRenderer(streamNameWidth));
+            if (outputFileName != "")
+            {
+                if (format == "table")
+                    renderers.push_back(getStreamingFileRenderer(outputFileName, streamNameWidth));
+                else if (format == "csv")
+                    renderers.push_back(getCsvRenderer(outputFileName));
+                else if (format == "jsonl")
+                    renderers.push_back(getJsonLinesRenderer(outputFileName));
+                else if (format == "binary")
+                    renderers.push_back(getBinaryRenderer(outputFileName));
+                else
+                    throw std::runtime_error("Unknown output format " + format);
+            }
+            std::vector<RecordRenderer*> stages;
+            for (const RecordRendererPtr& renderer : renderers)
+                stages.push_back(renderer.get());
+            runPipeline(inputFileName, *streamParser, *machine, stages, std::cout, PipelineOptions{ batchSize, queueDepth });
+            return 0;
+        }
+
+        InputParserPtr parser = isBinaryHitsFile(inputFileName) ? getBinaryInputParser() : getMappedInputParser(pool);
+        PlayersHits playersHits;
+        {
+            StageTimer timer(MetricStage::Parse);
+            playersHits = parser->ParseFile(inputFileName);
+        }
+        if (live)
+        {
+            //players throw their rolls in turn, the first wrong roll stops the player's game
+            LiveScoreboard scoreboard(std::cout, nameWidth != 0 ? nameWidth : DefaultNameWidth, std::chrono::milliseconds(liveRefreshMs));
+            std::vector<LiveGamePtr> games;
+            for (const PlayerHits& player : playersHits)
+                games.push_back(getLiveGame(player.playerName));
+            std::vector<bool> stopped(games.size(), false);
+            for (size_t roll = 0, playing = games.size(); playing != 0; ++roll)
+            {
+                playing = 0;
+                for (size_t i = 0; i < games.size(); ++i)
+                {
+                    if (stopped[i] || roll >= playersHits[i].hits.size())
+                        continue;
+                    try
+                    {
+                        games[i]->AddRoll(playersHits[i].hits[roll]);
+                    }
+                    catch (const std::runtime_error&)
+                    {
+                        stopped[i] = true;
+                    }
+                    scoreboard.Update(i, games[i]->Table());
+                    ++playing;
+                }
+                scoreboard.Refresh();
+            }
+            scoreboard.Flush();
+            return 0;
+        }
+        //wrong players are reported and skipped, the rest are rendered
+        PlayersStatus statuses;
+        PlayersTable playersResults;
+        {
+            StageTimer timer(MetricStage::Score);
+            playersResults = machine->TryCalcPlayersTable(playersHits, statuses);
+        }
+        size_t validCount = 0;
+        for (size_t i = 0; i < playersResults.size(); ++i)
+        {
+            if (!statuses[i].Ok())
+            {
+                std::cout << "Player " << playersHits[i].playerName << " is skipped, hit " << statuses[i].hitIndex + 1
+                    << ": " << machine->ErrorMessage(statuses[i].error) << "\n";
+                continue;
+            }
+            if (validCount != i)
+                playersResults[validCount] = std::move(playersResults[i]);
+            ++validCount;
+        }
+        playersResults.resize(validCount);
 
-        getConsoleRenderer()->Render(playersResults);
+        StageTimer renderTimer(MetricStage::Render);
+        if (leaderboard)
+            getLeaderboardConsoleRenderer(topCount, rankStyle, pool)->Render(playersResults);
+        else if (nameWidth != 0)
+            getStreamingConsoleRenderer(nameWidth)->Render(playersResults);
+        else
+            (parallel ? getParallelConsoleRenderer(pool) : getConsoleRenderer())->Render(playersResults);
         if (outputFileName != "")
         {
-            getFileRenderer(outputFileName)->Render(playersResults);
+            RendererPtr fileRenderer;
+            if (format == "table" && leaderboard)
+                fileRenderer = getLeaderboardFileRenderer(outputFileName, topCount, rankStyle, pool);
+            else if (format == "table" && nameWidth != 0)
+                fileRenderer = getStreamingFileRenderer(outputFileName, nameWidth);
+            else if (format == "table")
+                fileRenderer = parallel ? getParallelFileRenderer(outputFileName, pool) : getFileRenderer(outputFileName);
+            else if (format == "csv")
+                fileRenderer = getCsvRenderer(outputFileName);
+            else if (format == "jsonl")
+                fileRenderer = getJsonLinesRenderer(outputFileName);
+            else if (format == "binary")
+                fileRenderer = getBinaryRenderer(outputFileName);
+            else
+                throw std::runtime_error("Unknown output format " + format);
+            fileRenderer->Render(playersResults);
         }
     }
-    catch (std::exception e)
+    catch (const std::exception& e)
     {
         std::cout << "Exception occured: " << e.what();
+        return 1;
     }
 }
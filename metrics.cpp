@@ -0,0 +1,349 @@
+#include "metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace //anonymous
+{
+    ///Counters, then calls, wall and CPU nanoseconds of every stage
+    const size_t SlotCount = MetricCounterCount + 3 * MetricStageCount;
+
+    size_t StageSlot(MetricStage stage, size_t field)
+    {
+        return MetricCounterCount + 3 * static_cast<size_t>(stage) + field;
+    }
+
+    const char* const CounterNames[MetricCounterCount] =
+    {
+        "bytes_parsed",
+        "lines_parsed",
+        "players_scored",
+        "strikes",
+        "spares",
+        "errors",
+        "bytes_rendered",
+    };
+
+    const char* const CounterHelp[MetricCounterCount] =
+    {
+        "Bytes of input parsed",
+        "Lines of input parsed",
+        "Players scored without errors",
+        "Strikes of scored players",
+        "Spares of scored players",
+        "Players rejected by scoring and malformed lines",
+        "Bytes of output rendered",
+    };
+
+    const char* const StageNames[MetricStageCount] =
+    {
+        "parse",
+        "score",
+        "render",
+    };
+
+    ///Counters of one thread. Only the owner thread changes them, so relaxed load and store are
+    ///enough instead of locked add, other threads just read them. Own cache line, so threads
+    ///don't invalidate lines of each other
+    struct alignas(64) MetricShard
+    {
+        std::atomic<uint64_t> slots[SlotCount];
+    };
+
+    ///Shards of running threads, counters of finished threads are kept merged
+    class MetricsRegistry
+    {
+    private:
+        std::mutex m_mutex;
+        std::vector<MetricShard*> m_shards;
+        uint64_t m_finished[SlotCount];
+
+    public:
+        MetricsRegistry()
+            : m_finished()
+        {
+        }
+
+        void Register(MetricShard* shard)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shards.push_back(shard);
+        }
+
+        void Unregister(MetricShard* shard)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < SlotCount; ++i)
+                m_finished[i] += shard->slots[i].load(std::memory_order_relaxed);
+            m_shards.erase(std::find(m_shards.begin(), m_shards.end(), shard));
+        }
+
+        void Merge(uint64_t (&slots)[SlotCount])
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < SlotCount; ++i)
+                slots[i] = m_finished[i];
+            for (const MetricShard* shard : m_shards)
+            {
+                for (size_t i = 0; i < SlotCount; ++i)
+                    slots[i] += shard->slots[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        void Reset()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < SlotCount; ++i)
+                m_finished[i] = 0;
+            for (MetricShard* shard : m_shards)
+            {
+                for (size_t i = 0; i < SlotCount; ++i)
+                    shard->slots[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    ///Created before the first shard, so it outlives shards of all threads
+    MetricsRegistry& GetRegistry()
+    {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    class ThreadMetrics
+    {
+    private:
+        MetricShard m_shard;
+
+    public:
+        ThreadMetrics()
+        {
+            for (std::atomic<uint64_t>& slot : m_shard.slots)
+                slot.store(0, std::memory_order_relaxed);
+            GetRegistry().Register(&m_shard);
+        }
+
+        ~ThreadMetrics()
+        {
+            GetRegistry().Unregister(&m_shard);
+        }
+
+        void Add(size_t slot, uint64_t value)
+        {
+            std::atomic<uint64_t>& counter = m_shard.slots[slot];
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    };
+
+    ThreadMetrics& GetThreadMetrics()
+    {
+        thread_local ThreadMetrics metrics;
+        return metrics;
+    }
+
+    uint64_t ProcessCpuNanoseconds()
+    {
+#ifdef _WIN32
+        FILETIME creation, exitTime, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+            return 0;
+        const uint64_t kernelTime = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+        const uint64_t userTime = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+        return (kernelTime + userTime) * 100;
+#else
+        timespec time;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+            return 0;
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+#endif
+    }
+
+    std::string FormatSeconds(uint64_t nanoseconds)
+    {
+        return std::to_string(static_cast<double>(nanoseconds) / 1e9);
+    }
+
+    std::atomic<bool> MetricsEnabled(false);
+
+}   //namespace anonymous
+
+void addMetric(MetricCounter counter, uint64_t value)
+{
+    GetThreadMetrics().Add(static_cast<size_t>(counter), value);
+}
+
+void enableMetrics(bool enabled)
+{
+    MetricsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool metricsEnabled()
+{
+    return MetricsEnabled.load(std::memory_order_relaxed);
+}
+
+MetricsSnapshot getMetrics()
+{
+    uint64_t slots[SlotCount];
+    GetRegistry().Merge(slots);
+    MetricsSnapshot metrics;
+    for (size_t i = 0; i < MetricCounterCount; ++i)
+        metrics.counters[i] = slots[i];
+    for (size_t i = 0; i < MetricStageCount; ++i)
+    {
+        const MetricStage stage = static_cast<MetricStage>(i);
+        metrics.stages[i].calls = slots[StageSlot(stage, 0)];
+        metrics.stages[i].wallNanoseconds = slots[StageSlot(stage, 1)];
+        metrics.stages[i].cpuNanoseconds = slots[StageSlot(stage, 2)];
+    }
+    return metrics;
+}
+
+void resetMetrics()
+{
+    GetRegistry().Reset();
+}
+
+StageTimer::StageTimer(MetricStage stage)
+    : m_stage(stage)
+    , m_wallStart(std::chrono::steady_clock::now())
+    , m_cpuStart(ProcessCpuNanoseconds())
+{
+}
+
+StageTimer::~StageTimer()
+{
+    const uint64_t cpuEnd = ProcessCpuNanoseconds();
+    const auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_wallStart);
+    ThreadMetrics& metrics = GetThreadMetrics();
+    metrics.Add(StageSlot(m_stage, 0), 1);
+    metrics.Add(StageSlot(m_stage, 1), static_cast<uint64_t>(wall.count()));
+    metrics.Add(StageSlot(m_stage, 2), cpuEnd > m_cpuStart ? cpuEnd - m_cpuStart : 0);
+}
+
+std::string formatMetricsJson(const MetricsSnapshot& metrics)
+{
+    std::string result = "{";
+    for (size_t i = 0; i < MetricCounterCount; ++i)
+    {
+        result += '"';
+        result += CounterNames[i];
+        result += "\":";
+        result += std::to_string(metrics.counters[i]);
+        result += ',';
+    }
+    result += "\"stages\":{";
+    for (size_t i = 0; i < MetricStageCount; ++i)
+    {
+        const StageMetrics& stage = metrics.stages[i];
+        if (i != 0)
+            result += ',';
+        result += '"';
+        result += StageNames[i];
+        result += "\":{\"calls\":" + std::to_string(stage.calls)
+            + ",\"wall_seconds\":" + FormatSeconds(stage.wallNanoseconds)
+            + ",\"cpu_seconds\":" + FormatSeconds(stage.cpuNanoseconds) + "}";
+    }
+    result += "}}";
+    return result;
+}
+
+std::string formatMetricsPrometheus(const MetricsSnapshot& metrics)
+{
+    std::string result;
+    for (size_t i = 0; i < MetricCounterCount; ++i)
+    {
+        const std::string name = std::string("bowling_") + CounterNames[i] + "_total";
+        result += "# HELP " + name + " " + CounterHelp[i] + "\n";
+        result += "# TYPE " + name + " counter\n";
+        result += name + " " + std::to_string(metrics.counters[i]) + "\n";
+    }
+
+    struct StageField
+    {
+        const char* name;
+        const char* help;
+    };
+    const StageField fields[] =
+    {
+        { "bowling_stage_calls_total", "Times the stage ran" },
+        { "bowling_stage_wall_seconds_total", "Wall time of the stage" },
+        { "bowling_stage_cpu_seconds_total", "CPU time of the process while the stage ran" },
+    };
+    for (size_t field = 0; field < 3; ++field)
+    {
+        result += std::string("# HELP ") + fields[field].name + " " + fields[field].help + "\n";
+        result += std::string("# TYPE ") + fields[field].name + " counter\n";
+        for (size_t i = 0; i < MetricStageCount; ++i)
+        {
+            const StageMetrics& stage = metrics.stages[i];
+            result += std::string(fields[field].name) + "{stage=\"" + StageNames[i] + "\"} "
+                + (field == 0 ? std::to_string(stage.calls)
+                    : FormatSeconds(field == 1 ? stage.wallNanoseconds : stage.cpuNanoseconds)) + "\n";
+        }
+    }
+    return result;
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <thread>
+
+///Counters of finished and running threads are merged
+TEST(metrics, mergeThreads)
+{
+    resetMetrics();
+    addMetric(MetricCounter::LinesParsed, 3);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([]()
+        {
+            for (size_t n = 0; n < 1000; ++n)
+                addMetric(MetricCounter::LinesParsed, 1);
+            addMetric(MetricCounter::BytesParsed, 10);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    {
+        StageTimer timer(MetricStage::Parse);
+    }
+
+    const MetricsSnapshot metrics = getMetrics();
+    EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::LinesParsed)], 4003u);
+    EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::BytesParsed)], 40u);
+    EXPECT_EQ(metrics.counters[static_cast<size_t>(MetricCounter::Errors)], 0u);
+    EXPECT_EQ(metrics.stages[static_cast<size_t>(MetricStage::Parse)].calls, 1u);
+    EXPECT_EQ(metrics.stages[static_cast<size_t>(MetricStage::Score)].calls, 0u);
+
+    resetMetrics();
+    EXPECT_EQ(getMetrics().counters[static_cast<size_t>(MetricCounter::LinesParsed)], 0u);
+}
+
+TEST(metrics, formats)
+{
+    MetricsSnapshot metrics = {};
+    metrics.counters[static_cast<size_t>(MetricCounter::PlayersScored)] = 42;
+    metrics.stages[static_cast<size_t>(MetricStage::Score)] = StageMetrics{ 2, 1500000000, 250000000 };
+
+    EXPECT_EQ(formatMetricsJson(metrics),
+        "{\"bytes_parsed\":0,\"lines_parsed\":0,\"players_scored\":42,\"strikes\":0,\"spares\":0,\"errors\":0,\"bytes_rendered\":0,"
+        "\"stages\":{\"parse\":{\"calls\":0,\"wall_seconds\":0.000000,\"cpu_seconds\":0.000000},"
+        "\"score\":{\"calls\":2,\"wall_seconds\":1.500000,\"cpu_seconds\":0.250000},"
+        "\"render\":{\"calls\":0,\"wall_seconds\":0.000000,\"cpu_seconds\":0.000000}}}");
+
+    const std::string text = formatMetricsPrometheus(metrics);
+    EXPECT_NE(text.find("# TYPE bowling_players_scored_total counter\nbowling_players_scored_total 42\n"), std::string::npos);
+    EXPECT_NE(text.find("bowling_stage_wall_seconds_total{stage=\"score\"} 1.500000\n"), std::string::npos);
+}
+
+#endif //UNITTEST
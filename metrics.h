@@ -0,0 +1,85 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+///Counters of processed data, summed over all threads
+enum class MetricCounter
+{
+    BytesParsed,
+    LinesParsed,
+    PlayersScored,      ///players scored without errors
+    Strikes,            ///strike symbols of scored players, bonus strikes of 10th frame included
+    Spares,
+    Errors,             ///players rejected by scoring and malformed lines answered by server
+    BytesRendered,
+    Count,
+};
+
+///Stages of a run which are timed
+enum class MetricStage
+{
+    Parse,
+    Score,
+    Render,
+    Count,
+};
+
+const size_t MetricCounterCount = static_cast<size_t>(MetricCounter::Count);
+const size_t MetricStageCount = static_cast<size_t>(MetricStage::Count);
+
+///Add value to counter of the calling thread. Every thread has its own counters, so adding costs
+///a few instructions without locks and threads don't contend for cache lines
+void addMetric(MetricCounter counter, uint64_t value);
+
+///Counters which cost a pass of their own over results, like strikes and spares of scored
+///players, are collected only while enabled, so runs nobody reads metrics of don't pay for them.
+///Disabled by default
+void enableMetrics(bool enabled);
+bool metricsEnabled();
+
+struct StageMetrics
+{
+    uint64_t calls;
+    uint64_t wallNanoseconds;
+    uint64_t cpuNanoseconds;    ///CPU time of the whole process while the stage ran
+};
+
+struct MetricsSnapshot
+{
+    uint64_t counters[MetricCounterCount];
+    StageMetrics stages[MetricStageCount];
+};
+
+///Merge counters of all threads, finished ones included. Can be called while other threads add
+MetricsSnapshot getMetrics();
+///Zero counters of all threads, values added at the same time may be lost
+void resetMetrics();
+
+///Adds wall and CPU time from construction to destruction to the stage. CPU time is of the whole
+///process, so it includes the pool threads working for the stage, and stages running at once
+///(pipeline, batch) see CPU time of each other
+class StageTimer
+{
+public:
+    explicit StageTimer(MetricStage stage);
+    ~StageTimer();
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator = (const StageTimer&) = delete;
+
+private:
+    const MetricStage m_stage;
+    const std::chrono::steady_clock::time_point m_wallStart;
+    const uint64_t m_cpuStart;
+};
+
+///Snapshot as JSON object in one line
+std::string formatMetricsJson(const MetricsSnapshot& metrics);
+///Snapshot in Prometheus text exposition format
+std::string formatMetricsPrometheus(const MetricsSnapshot& metrics);
+
+#endif //METRICS_H
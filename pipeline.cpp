@@ -0,0 +1,284 @@
+#include "pipeline.h"
+#include "metrics.h"
+#include "spsc_queue.h"
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace //anonymous
+{
+    struct ScoredBatch
+    {
+        PlayersHits hits;
+        PlayersTable table;
+        PlayersStatus statuses;
+    };
+
+    ///The first exception of stages, the stage which failed closes its queues to stop the others
+    class StageErrors
+    {
+    private:
+        std::mutex m_mutex;
+        std::exception_ptr m_error;
+
+    public:
+        void Set(std::exception_ptr error)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+                m_error = error;
+        }
+
+        void Rethrow()
+        {
+            if (m_error)
+                std::rethrow_exception(m_error);
+        }
+    };
+
+}   //namespace anonymous
+
+void runPipeline(const std::string& inputFileName, InputParser& parser, BowlingMachine& machine,
+    const std::vector<RecordRenderer*>& renderers, std::ostream& log, const PipelineOptions& options)
+{
+    const size_t batchSize = std::max<size_t>(1, options.batchSize);
+    SpscQueue<PlayersHits> parsedQueue(std::max<size_t>(1, options.queueDepth));
+    SpscQueue<ScoredBatch> scoredQueue(std::max<size_t>(1, options.queueDepth));
+    StageErrors errors;
+
+    //stopped pipeline throws out of parser handler, the error is already reported by other stage
+    struct Stopped {};
+
+    //stages wait for each other through queues, so wall times of stages include the waits
+    std::thread parseStage([&]()
+    {
+        StageTimer timer(MetricStage::Parse);
+        try
+        {
+            PlayersHits batch;
+            batch.reserve(batchSize);
+            parser.ForEachPlayerInFile(inputFileName, [&](PlayerHits& player)
+            {
+                batch.push_back(std::move(player));
+                if (batch.size() == batchSize)
+                {
+                    if (!parsedQueue.Push(batch))
+                        throw Stopped();
+                    batch.clear();
+                    batch.reserve(batchSize);
+                }
+            });
+            if (!batch.empty())
+                parsedQueue.Push(batch);
+        }
+        catch (const Stopped&)
+        {
+        }
+        catch (...)
+        {
+            errors.Set(std::current_exception());
+            scoredQueue.Close();
+        }
+        parsedQueue.Close();
+    });
+
+    std::thread scoreStage([&]()
+    {
+        StageTimer timer(MetricStage::Score);
+        try
+        {
+            ScoredBatch scored;
+            while (parsedQueue.Pop(scored.hits))
+            {
+                scored.table = machine.TryCalcPlayersTable(scored.hits, scored.statuses);
+                if (!scoredQueue.Push(scored))
+                    break;
+            }
+        }
+        catch (...)
+        {
+            errors.Set(std::current_exception());
+        }
+        parsedQueue.Close();
+        scoredQueue.Close();
+    });
+
+    StageTimer renderTimer(MetricStage::Render);
+    try
+    {
+        ScoredBatch scored;
+        while (scoredQueue.Pop(scored))
+        {
+            for (size_t i = 0; i < scored.table.size(); ++i)
+            {
+                if (!scored.statuses[i].Ok())
+                {
+                    //log may be the stream of a renderer, its buffered rows of earlier players go first
+                    for (RecordRenderer* renderer : renderers)
+                        renderer->Flush();
+                    log << "Player " << scored.hits[i].playerName << " is skipped, hit " << scored.statuses[i].hitIndex + 1
+                        << ": " << machine.ErrorMessage(scored.statuses[i].error) << "\n";
+                    continue;
+                }
+                for (RecordRenderer* renderer : renderers)
+                    renderer->Write(scored.table[i]);
+            }
+        }
+    }
+    catch (...)
+    {
+        errors.Set(std::current_exception());
+    }
+    scoredQueue.Close();
+    parsedQueue.Close();
+    parseStage.join();
+    scoreStage.join();
+    errors.Rethrow();
+
+    for (RecordRenderer* renderer : renderers)
+        renderer->Finish();
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+TEST(spscQueue, keepsOrderAcrossThreads)
+{
+    SpscQueue<size_t> queue(3);
+    std::thread producer([&queue]()
+    {
+        for (size_t i = 0; i < 100000; ++i)
+        {
+            size_t item = i;
+            ASSERT_TRUE(queue.Push(item));
+        }
+        queue.Close();
+    });
+    size_t item = 0;
+    size_t expected = 0;
+    while (queue.Pop(item))
+        ASSERT_EQ(item, expected++);
+    producer.join();
+    EXPECT_EQ(expected, 100000u);
+}
+
+TEST(spscQueue, consumerCloseStopsProducer)
+{
+    SpscQueue<size_t> queue(1);
+    size_t item = 1;
+    EXPECT_TRUE(queue.Push(item));
+    queue.Close();
+    EXPECT_FALSE(queue.Push(item));
+    EXPECT_TRUE(queue.Pop(item));
+    EXPECT_FALSE(queue.Pop(item));
+}
+
+namespace //anonymous
+{
+    std::string ReadFile(const std::string& filename)
+    {
+        std::ifstream input(filename, std::ios::binary);
+        std::stringstream content;
+        content << input.rdbuf();
+        return content.str();
+    }
+}   //namespace anonymous
+
+///Pipeline gives the same records and skip reports as scoring the whole file at once
+TEST(pipeline, matchesSequential)
+{
+    const std::string inputName = "pipeline_test_input.tmp";
+    const std::string outputName = "pipeline_test_output.tmp";
+    {
+        std::ofstream input(inputName, std::ios::binary);
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            if (i % 97 == 5)
+                input << "Wrong" << i << ": 10 10 10\n";
+            else
+                input << "Player" << i << ": " << (i % 10) << " " << (10 - i % 10) << " 3 4 10 10 10 1 2 0 0 5 5 5 0 0 0\n";
+        }
+    }
+
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    const PlayersHits hits = parser->ParseFile(inputName);
+    PlayersStatus statuses;
+    const PlayersTable table = machine->TryCalcPlayersTable(hits, statuses);
+    std::ostringstream expectedLog;
+    RecordRendererPtr expectedRenderer = getCsvRenderer(outputName);
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        if (statuses[i].Ok())
+            expectedRenderer->Write(table[i]);
+        else
+            expectedLog << "Player " << hits[i].playerName << " is skipped, hit " << statuses[i].hitIndex + 1
+                << ": " << scoreErrorMessage(statuses[i].error) << "\n";
+    }
+    expectedRenderer->Finish();
+    expectedRenderer.reset();
+    const std::string expected = ReadFile(outputName);
+
+    ThreadPool pool(3);
+    BowlingMachinePtr parallelMachine = getParallelBowlingMachine(pool);
+    for (size_t batchSize : { 1, 7, 4096 })
+    {
+        std::ostringstream log;
+        {
+            RecordRendererPtr renderer = getCsvRenderer(outputName);
+            runPipeline(inputName, *parser, *parallelMachine, { renderer.get() }, log, PipelineOptions{ batchSize, 2 });
+        }
+        EXPECT_EQ(ReadFile(outputName), expected);
+        EXPECT_EQ(log.str(), expectedLog.str());
+    }
+
+    //console table and log share the stream, every report comes between rows of its neighbours
+    std::vector<std::string> expectedNames;
+    for (const PlayerHits& player : hits)
+        expectedNames.push_back(player.playerName);
+    std::ostringstream console;
+    std::streambuf* const consoleBuffer = std::cout.rdbuf(console.rdbuf());
+    {
+        RecordRendererPtr renderer = getStreamingConsoleRenderer(16);
+        runPipeline(inputName, *parser, *parallelMachine, { renderer.get() }, std::cout, PipelineOptions{ 64, 2 });
+    }
+    std::cout.rdbuf(consoleBuffer);
+    std::vector<std::string> names;
+    std::istringstream lines(console.str());
+    std::string line;
+    const std::string skipped = "Player ";
+    while (std::getline(lines, line))
+    {
+        if (line.compare(0, skipped.size(), skipped) == 0)
+            names.push_back(line.substr(skipped.size(), line.find(' ', skipped.size()) - skipped.size()));
+        else if (line.size() > 1 && line[0] == '|' && line[1] != ' ' && std::count(line.begin(), line.end(), '|') > 2)   //not footer
+            names.push_back(line.substr(1, line.find_first_of(" |", 1) - 1));
+    }
+    EXPECT_EQ(names, expectedNames);
+
+    std::remove(inputName.c_str());
+    std::remove(outputName.c_str());
+}
+
+TEST(pipeline, parserErrorIsRethrown)
+{
+    const std::string inputName = "pipeline_test_input.tmp";
+    {
+        std::ofstream input(inputName, std::ios::binary);
+        for (size_t i = 0; i < 100; ++i)
+            input << "Player" << i << ": 1 2 3 4 5 4 3 2 1 0 1 2 3 4 5 4 3 2 1 0\n";
+        input << "Broken: 1 2x\n";
+    }
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    std::ostringstream log;
+    EXPECT_THROW(runPipeline(inputName, *parser, *machine, {}, log, PipelineOptions{ 8, 1 }), std::runtime_error);
+    std::remove(inputName.c_str());
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "bowling_machine.h"
+#include "input_parser.h"
+#include "result_renderer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PipelineOptions
+{
+    size_t batchSize;       ///players passed between stages at once
+    size_t queueDepth;      ///batches waiting between two stages
+};
+
+///Parse, score and render input file as concurrent stages connected by bounded lock-free queues
+///of player batches, so stages overlap and memory is bounded by queue depth instead of file size.
+///Players keep file order. Wrong players are skipped and reported to log after renderers are
+///flushed, so the report follows rows of the players before it even when log is the stream of a
+///renderer. Exception of any stage stops the others and is rethrown
+void runPipeline(const std::string& inputFileName, InputParser& parser, BowlingMachine& machine,
+    const std::vector<RecordRenderer*>& renderers, std::ostream& log, const PipelineOptions& options);
+
+#endif //PIPELINE_H
@@ -0,0 +1,76 @@
+#include "positional_file.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+PositionalFile::PositionalFile(const std::string& filename)
+    : m_filename(filename)
+    , m_file(INVALID_HANDLE_VALUE)
+{
+    m_file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Can't open file " + filename);
+}
+
+PositionalFile::~PositionalFile()
+{
+    CloseHandle(m_file);
+}
+
+void PositionalFile::WriteAt(uint64_t offset, const char* data, size_t size)
+{
+    while (size != 0)
+    {
+        //offset of synchronous handle is taken from OVERLAPPED, so threads don't share file pointer
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD block = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(m_file, data, block, &written, &position) || written == 0)
+            throw std::runtime_error("Can't write file " + m_filename);
+        offset += written;
+        data += written;
+        size -= written;
+    }
+}
+
+#else
+
+PositionalFile::PositionalFile(const std::string& filename)
+    : m_filename(filename)
+    , m_file(open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644))
+{
+    if (m_file < 0)
+        throw std::runtime_error("Can't open file " + filename);
+}
+
+PositionalFile::~PositionalFile()
+{
+    close(m_file);
+}
+
+void PositionalFile::WriteAt(uint64_t offset, const char* data, size_t size)
+{
+    while (size != 0)
+    {
+        const ssize_t written = pwrite(m_file, data, size, static_cast<off_t>(offset));
+        if (written <= 0)
+            throw std::runtime_error("Can't write file " + m_filename);
+        offset += written;
+        data += written;
+        size -= written;
+    }
+}
+
+#endif
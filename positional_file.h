@@ -0,0 +1,31 @@
+#ifndef POSITIONAL_FILE_H
+#define POSITIONAL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+///File opened for writing blocks at given offsets, blocks can be written from several threads at once
+class PositionalFile
+{
+public:
+    ///Create or truncate file, throws std::runtime_error if file can't be opened
+    explicit PositionalFile(const std::string& filename);
+    ~PositionalFile();
+
+    PositionalFile(const PositionalFile&) = delete;
+    PositionalFile& operator = (const PositionalFile&) = delete;
+
+    ///Write size bytes at offset, throws std::runtime_error if they can't be written
+    void WriteAt(uint64_t offset, const char* data, size_t size);
+
+private:
+    std::string m_filename;
+#ifdef _WIN32
+    void* m_file;
+#else
+    int m_file;
+#endif
+};
+
+#endif //POSITIONAL_FILE_H
@@ -0,0 +1,180 @@
+#include "ranking.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace //anonymous
+{
+    ///Players scanned by one task of parallel top search
+    const size_t RankChunkSize = 64 * 1024;
+
+    ///Orders players the way they are ranked: higher total first, then table order
+    class RankOrder
+    {
+    private:
+        const PlayersTable& m_table;
+
+    public:
+        explicit RankOrder(const PlayersTable& table)
+            : m_table(table)
+        {
+        }
+
+        bool operator () (size_t left, size_t right) const
+        {
+            const unsigned int leftTotal = m_table[left].total;
+            const unsigned int rightTotal = m_table[right].total;
+            return leftTotal > rightTotal || (leftTotal == rightTotal && left < right);
+        }
+    };
+
+    ///Add best topCount players of [begin, end) to heap, heap front is the worst kept player
+    void CollectTop(const PlayersTable& table, size_t begin, size_t end, size_t topCount, std::vector<size_t>& heap)
+    {
+        if (topCount == 0)
+            return;
+        const RankOrder order(table);
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (heap.size() < topCount)
+            {
+                heap.push_back(i);
+                std::push_heap(heap.begin(), heap.end(), order);
+            }
+            else if (order(i, heap.front()))
+            {
+                std::pop_heap(heap.begin(), heap.end(), order);
+                heap.back() = i;
+                std::push_heap(heap.begin(), heap.end(), order);
+            }
+        }
+    }
+
+    ///Rank players sorted by RankOrder. Every player with greater total is before the player,
+    ///so ranks of any prefix are the same as ranks in the whole table
+    Ranking AssignRanks(const PlayersTable& table, const std::vector<size_t>& sorted, RankStyle style)
+    {
+        Ranking ranking(sorted.size());
+        unsigned int rank = 0;
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            if (i == 0 || table[sorted[i]].total != table[sorted[i - 1]].total)
+                rank = style == RankStyle::Dense ? rank + 1 : static_cast<unsigned int>(i + 1);
+            ranking[i].index = sorted[i];
+            ranking[i].rank = rank;
+        }
+        return ranking;
+    }
+
+}   //namespace anonymous
+
+Ranking rankPlayers(const PlayersTable& table, RankStyle style)
+{
+    std::vector<size_t> sorted(table.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+        sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(), RankOrder(table));
+    return AssignRanks(table, sorted, style);
+}
+
+Ranking topPlayers(const PlayersTable& table, size_t topCount, RankStyle style)
+{
+    std::vector<size_t> heap;
+    heap.reserve(std::min(topCount, table.size()));
+    CollectTop(table, 0, table.size(), topCount, heap);
+    std::sort_heap(heap.begin(), heap.end(), RankOrder(table));
+    return AssignRanks(table, heap, style);
+}
+
+Ranking topPlayers(const PlayersTable& table, size_t topCount, RankStyle style, ThreadPool& pool)
+{
+    const size_t chunkCount = (table.size() + RankChunkSize - 1) / RankChunkSize;
+    std::vector<std::vector<size_t>> heaps(chunkCount);
+    pool.ParallelFor(chunkCount, 1, [&table, topCount, &heaps](size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            CollectTop(table, chunk * RankChunkSize, std::min(table.size(), (chunk + 1) * RankChunkSize),
+                topCount, heaps[chunk]);
+        }
+    });
+
+    //the best topCount of all chunks are among the best topCount of every chunk
+    std::vector<size_t> candidates;
+    for (const std::vector<size_t>& heap : heaps)
+        candidates.insert(candidates.end(), heap.begin(), heap.end());
+    const RankOrder order(table);
+    const size_t count = std::min(topCount, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), order);
+    candidates.resize(count);
+    return AssignRanks(table, candidates, style);
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include "bowling_machine.h"
+#include "game_generator.h"
+
+namespace //anonymous
+{
+    PlayersTable MakeRankTable(const std::vector<unsigned int>& totals)
+    {
+        PlayersTable table(totals.size());
+        for (size_t i = 0; i < totals.size(); ++i)
+        {
+            table[i].playerName = "Player" + std::to_string(i);
+            table[i].total = totals[i];
+        }
+        return table;
+    }
+}   //namespace anonymous
+
+TEST(ranking, denseAndCompetition)
+{
+    const PlayersTable table = MakeRankTable({ 150, 300, 150, 90, 300, 120 });
+
+    const Ranking dense = rankPlayers(table, RankStyle::Dense);
+    const std::vector<size_t> order = { 1, 4, 0, 2, 5, 3 };
+    const std::vector<unsigned int> denseRanks = { 1, 1, 2, 2, 3, 4 };
+    const std::vector<unsigned int> competitionRanks = { 1, 1, 3, 3, 5, 6 };
+    ASSERT_EQ(dense.size(), order.size());
+    const Ranking competition = rankPlayers(table, RankStyle::Competition);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        EXPECT_EQ(dense[i].index, order[i]);
+        EXPECT_EQ(dense[i].rank, denseRanks[i]);
+        EXPECT_EQ(competition[i].index, order[i]);
+        EXPECT_EQ(competition[i].rank, competitionRanks[i]);
+    }
+}
+
+///Top of any size and parallel top are prefixes of the full ranking
+TEST(ranking, topIsRankingPrefix)
+{
+    PlayersHits players(200000);
+    const GeneratorOptions options;
+    for (size_t i = 0; i < players.size(); ++i)
+        generatePlayer(options, i, players[i]);
+    const PlayersTable table = getBowlingMachine()->CalcPlayersTable(players);
+    ThreadPool pool(4);
+    for (RankStyle style : { RankStyle::Dense, RankStyle::Competition })
+    {
+        const Ranking full = rankPlayers(table, style);
+        for (size_t topCount : { size_t(0), size_t(1), size_t(100), size_t(5000), table.size() + 1 })
+        {
+            const Ranking top = topPlayers(table, topCount, style);
+            const Ranking parallelTop = topPlayers(table, topCount, style, pool);
+            ASSERT_EQ(top.size(), std::min(topCount, table.size()));
+            ASSERT_EQ(parallelTop.size(), top.size());
+            for (size_t i = 0; i < top.size(); ++i)
+            {
+                EXPECT_EQ(top[i].index, full[i].index);
+                EXPECT_EQ(top[i].rank, full[i].rank);
+                EXPECT_EQ(parallelTop[i].index, full[i].index);
+                EXPECT_EQ(parallelTop[i].rank, full[i].rank);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include "types.h"
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+///How players with equal totals share ranks
+enum class RankStyle
+{
+    Dense,          ///1, 2, 2, 3 - next rank after tie is the next number
+    Competition,    ///1, 2, 2, 4 - next rank after tie skips tied places
+};
+
+struct PlayerRank
+{
+    size_t index;       ///player index in PlayersTable
+    unsigned int rank;
+};
+
+///Players ordered by total descending, players with equal totals keep table order
+typedef std::vector<PlayerRank> Ranking;
+
+///Rank of every player, sorts the whole table
+Ranking rankPlayers(const PlayersTable& table, RankStyle style);
+
+///First topCount players of rankPlayers with the same ranks. Keeps bounded heap of topCount
+///players instead of sorting the table, so it takes O(n log topCount)
+Ranking topPlayers(const PlayersTable& table, size_t topCount, RankStyle style);
+
+///Same as topPlayers, chunks of table are scanned by their own heaps on pool threads and merged
+Ranking topPlayers(const PlayersTable& table, size_t topCount, RankStyle style, ThreadPool& pool);
+
+#endif //RANKING_H
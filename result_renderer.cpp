@@ -1,26 +1,239 @@
 #include "result_renderer.h"
+#include "metrics.h"
+#include "positional_file.h"
+#include "ranking.h"
+#include "thread_pool.h"
 #include <assert.h>
 #include <algorithm>
-#include <iostream>
-#include <iomanip>
 #include <fstream>
+#include <iostream>
+#include <stdexcept>
 
 namespace //anonymous
 {
-    class WinTableBuilder
+    ///Rows are formatted into buffer and written out when it grows over
+    const size_t FlushSize = 64 * 1024;
+
+    ///Players formatted by one task of parallel rendering
+    const size_t RenderChunkSize = 1024;
+
+    ///Hits of ten-pin frame before the 10th, frames of strikes are padded to them
+    const size_t TenPinFrameHits = 2;
+
+    ///Widths shared by all rows of the table
+    struct TableLayout
     {
-    private:
-        size_t m_tableWidth;
+        size_t maxPlayerNameLen;
+        size_t maxFrameHits;    ///hits of frames before the 10th, balls per frame of the rules
+        size_t maxTenFrameHits;
+        size_t tableWidth;
+        bool truncateNames;     ///longer names are cut to maxPlayerNameLen instead of widening the row
+
+        size_t FrameWidth() const { return maxFrameHits * 2 - 1; }
+        size_t TenFrameWidth() const { return maxTenFrameHits * 2 - 1; }
+        size_t NameLength(const std::string& name) const { return truncateNames ? std::min(name.size(), maxPlayerNameLen) : name.size(); }
+    };
+
+    TableLayout MakeLayout(size_t maxPlayerNameLen, size_t maxFrameHits, size_t maxTenFrameHits, bool truncateNames)
+    {
+        TableLayout layout = {};
+        layout.maxPlayerNameLen = maxPlayerNameLen;
+        layout.maxFrameHits = maxFrameHits;
+        layout.maxTenFrameHits = maxTenFrameHits;
+        layout.truncateNames = truncateNames;
+        layout.tableWidth += 1;     //open dash
+        layout.tableWidth += layout.maxPlayerNameLen; //player name field
+        layout.tableWidth += (1 + layout.FrameWidth()) * (FramesPerGame-1);    //size of all frames except 10th
+        layout.tableWidth += 1 + layout.maxTenFrameHits * 2 - 1;  //10th frame
+        layout.tableWidth += 1 + 3;    //total summ
+        layout.tableWidth += 1;        //close dash
+        return layout;
+    }
 
-        ///Draw string of '-' to delimit strings on table
-        void DrawStringDelimiter(std::ostream& out)
+    ///Widths fit every player of the table, frames are as wide as balls per frame of the rules
+    ///the players were scored by
+    TableLayout MakeLayout(const PlayersTable& table)
+    {
+        size_t maxPlayerNameLen = 0;
+        size_t maxFrameHits = TenPinFrameHits;
+        size_t maxTenFrameHits = 0;
+        for (const PlayerTable& player : table)
         {
-            for (size_t i = 0; i < m_tableWidth; ++i)
+            maxPlayerNameLen = std::max(maxPlayerNameLen, player.playerName.size());
+            for (size_t i = 0; i < player.frames.size() - 1; ++i)
+                maxFrameHits = std::max(maxFrameHits, player.frames[i].hit.size());
+            maxTenFrameHits = std::max(maxTenFrameHits, player.frames[9].hit.size());
+        }
+        return MakeLayout(maxPlayerNameLen, maxFrameHits, maxTenFrameHits, false);
+    }
+
+    void AppendSpaces(std::string& buffer, size_t count)
+    {
+        buffer.append(count, ' ');
+    }
+
+    ///Append text left aligned in field of width characters
+    void AppendLeft(std::string& buffer, const char* text, size_t size, size_t width)
+    {
+        buffer.append(text, size);
+        if (size < width)
+            AppendSpaces(buffer, width - size);
+    }
+
+    size_t NumberLength(unsigned int number)
+    {
+        size_t length = 1;
+        while (number >= 10)
+        {
+            number /= 10;
+            ++length;
+        }
+        return length;
+    }
+
+    ///Append number left aligned in field of width characters
+    void AppendNumber(std::string& buffer, unsigned int number, size_t width)
+    {
+        char digits[16];
+        char* end = digits + sizeof(digits);
+        char* begin = end;
+        do
+        {
+            *--begin = static_cast<char>('0' + number % 10);
+            number /= 10;
+        } while (number != 0);
+        AppendLeft(buffer, begin, end - begin, width);
+    }
+
+    size_t HitsLength(const FrameHits& hits)
+    {
+        return hits.empty() ? 0 : hits.size() * 2 - 1;
+    }
+
+    void AppendHits(std::string& buffer, const FrameHits& hits)
+    {
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            buffer += hits[i];
+            if (i != hits.size() - 1)
+                buffer += ' ';
+        }
+    }
+
+    ///Draw string of '-' to delimit strings on table
+    void AppendDelimiter(std::string& buffer, const TableLayout& layout)
+    {
+        buffer.append(layout.tableWidth, '-');
+        buffer += '\n';
+    }
+
+    ///Delimiter and two table strings of player
+    void AppendPlayerRows(std::string& buffer, const PlayerTable& player, const TableLayout& layout)
+    {
+        AppendDelimiter(buffer, layout);
+
+        //1th string
+        buffer += '|';
+        AppendLeft(buffer, player.playerName.data(), layout.NameLength(player.playerName), layout.maxPlayerNameLen);
+        for (size_t i = 0; i < player.frames.size() - 1; ++i)
+        {
+            const Frame& frame = player.frames[i];
+            buffer += '|';
+            AppendHits(buffer, frame.hit);
+            if (!frame.hit.empty())     //frames not played yet stay empty
+                AppendSpaces(buffer, layout.FrameWidth() - HitsLength(frame.hit));     //strike or early spare
+        }
+        const Frame& tenFrame = player.frames[9];  //10th frame
+        buffer += '|';
+        AppendHits(buffer, tenFrame.hit);
+        AppendSpaces(buffer, layout.TenFrameWidth() - (tenFrame.hit.size() * 2 - 1));
+        buffer += "|   ";   //len of total is always three
+        buffer += "|\n";
+
+        //2th string
+        buffer += '|';
+        AppendSpaces(buffer, layout.maxPlayerNameLen);
+        for (size_t i = 0; i < player.frames.size() - 1; ++i)
+        {
+            const Frame& frame = player.frames[i];
+            buffer += '|';
+            AppendNumber(buffer, frame.result, layout.FrameWidth());
+        }
+        buffer += '|';
+        AppendNumber(buffer, tenFrame.result, layout.TenFrameWidth());
+
+        buffer += '|';
+        AppendNumber(buffer, player.total, 3);
+        buffer += "|\n";
+    }
+
+    ///Exact size of AppendPlayerRows output, so rows offsets are known before formatting
+    size_t PlayerRowsSize(const PlayerTable& player, const TableLayout& layout)
+    {
+        size_t size = layout.tableWidth + 1;
+
+        size += 1 + std::max(layout.NameLength(player.playerName), layout.maxPlayerNameLen);
+        for (size_t i = 0; i < player.frames.size() - 1; ++i)
+        {
+            size += 1 + (player.frames[i].hit.empty() ? 0 : layout.FrameWidth());
+        }
+        const Frame& tenFrame = player.frames[9];
+        size += 1 + HitsLength(tenFrame.hit) + (layout.TenFrameWidth() - (tenFrame.hit.size() * 2 - 1)) + 4 + 2;
+
+        size += 1 + layout.maxPlayerNameLen;
+        for (size_t i = 0; i < player.frames.size() - 1; ++i)
+        {
+            const Frame& frame = player.frames[i];
+            size += 1 + std::max(NumberLength(frame.result), layout.FrameWidth());
+        }
+        size += 1 + std::max(NumberLength(tenFrame.result), layout.TenFrameWidth());
+        size += 1 + std::max<size_t>(NumberLength(player.total), 3) + 2;
+        return size;
+    }
+
+    ///Hint of names of winnerCount winners joined by " and "
+    std::string GetWinnersString(const std::string& names, size_t winnerCount)
+    {
+        return names + (winnerCount == 1 ? " is winner! Congratulations!" : " are tied!");
+    }
+
+    std::string GetWinnersString(const std::vector<std::string>& winners)
+    {
+        std::string names;
+        for (size_t i = 0; i < winners.size(); ++i)
+        {
+            names += winners[i];
+            if (i != winners.size() - 1)
             {
-                out << '-';
+                names += " and ";
             }
-            out << std::endl;
         }
+        return GetWinnersString(names, winners.size());
+    }
+
+    void AppendFooter(std::string& buffer, const std::string& hint, const TableLayout& layout)
+    {
+        //hint
+        AppendDelimiter(buffer, layout);
+        buffer += '|';
+        //tied winners may not fit into the table, then the hint isn't centered
+        const size_t padding = hint.size() + 2 < layout.tableWidth ? layout.tableWidth - 2 - hint.size() : 0;
+        AppendSpaces(buffer, padding / 2);
+        buffer += hint;
+        AppendSpaces(buffer, padding - padding / 2);
+        buffer += "|\n";
+
+        AppendDelimiter(buffer, layout);
+    }
+
+    ///Formats table into byte buffers and writes them by large blocks, so output doesn't pay for
+    ///per-character stream calls and flushes. Rows of players are independent, so with thread pool
+    ///they are formatted by chunks in parallel
+    class WinTableBuilder
+    {
+    private:
+        std::string m_buffer;
+        std::vector<std::string> m_chunks;
 
         std::vector<std::string> GetWinners(const PlayersTable& table)
         {
@@ -42,150 +255,122 @@ namespace //anonymous
             return winners;
         }
 
-        std::string GetWinnersString(const std::vector<std::string>& winners)
+        void Flush(std::ostream& out)
         {
-            if (winners.size() == 1)
-            {
-                return winners[0] + " is winner! Congratulations!";
-            }
-
-            std::string result;
-            for (size_t i = 0; i < winners.size(); ++i)
-            {
-                result += winners[i];
-                if (i != winners.size() - 1)
-                {
-                    result += " and ";
-                }
-            }
-            result += " are tied!";
-            return result;
+            out.write(m_buffer.data(), m_buffer.size());
+            addMetric(MetricCounter::BytesRendered, m_buffer.size());
+            m_buffer.clear();
         }
 
     public:
-        WinTableBuilder()
-            : m_tableWidth(0)
-        {
-        }
-
         void Build(std::ostream& out, const PlayersTable& table)
         {
-            m_tableWidth = 0;
-            m_tableWidth += 1;     //open dash
-            size_t maxPlayerNameLen = 0;
+            const TableLayout layout = MakeLayout(table);
+            m_buffer.clear();
+            m_buffer.reserve(FlushSize + 4 * layout.tableWidth);
             for (const PlayerTable& player : table)
             {
-                if (player.playerName.size() > maxPlayerNameLen)
-                    maxPlayerNameLen = player.playerName.size();
-            }
-            m_tableWidth += maxPlayerNameLen; //player name field
-            m_tableWidth += 4 * (FramesPerGame-1);    //size of all frames except 10th
-            size_t maxTenFrameHits = 0;
-            for (const auto& player : table)
-            {
-                const size_t hitCount = player.frames[9].hit.size();
-                if (hitCount > maxTenFrameHits)
-                    maxTenFrameHits = hitCount;
+                AppendPlayerRows(m_buffer, player, layout);
+                if (m_buffer.size() >= FlushSize)
+                    Flush(out);
             }
-            m_tableWidth += 1 + maxTenFrameHits * 2 - 1;  //10th frame
-            m_tableWidth += 1 + 3;    //total summ
-            m_tableWidth += 1;        //close dash
+            AppendFooter(m_buffer, GetWinnersString(GetWinners(table)), layout);
+            Flush(out);
+            out.flush();
+        }
 
-            unsigned int maxPlayerResult = 0;
-            std::vector<std::string> winners;
-            for (const PlayerTable& player : table)
+        ///Format chunks of players in parallel and write them in order, a few chunks per thread at once
+        void Build(std::ostream& out, const PlayersTable& table, ThreadPool& pool)
+        {
+            const TableLayout layout = MakeLayout(table);
+            const size_t chunkCount = (table.size() + RenderChunkSize - 1) / RenderChunkSize;
+            m_chunks.resize(std::min(chunkCount, 4 * pool.ThreadCount()));
+            for (size_t first = 0; first < chunkCount; first += m_chunks.size())
             {
-                if (player.total > maxPlayerResult)
+                const size_t count = std::min(m_chunks.size(), chunkCount - first);
+                pool.ParallelFor(count, 1, [this, &table, &layout, first](size_t begin, size_t end)
                 {
-                    maxPlayerResult = player.total;
-                    winners.clear();
-                    winners.push_back(player.playerName);
-                }
-                else if (player.total == maxPlayerResult)
+                    for (size_t chunk = begin; chunk < end; ++chunk)
+                    {
+                        std::string& buffer = m_chunks[chunk];
+                        buffer.clear();
+                        const size_t last = std::min(table.size(), (first + chunk + 1) * RenderChunkSize);
+                        for (size_t i = (first + chunk) * RenderChunkSize; i < last; ++i)
+                            AppendPlayerRows(buffer, table[i], layout);
+                    }
+                });
+                for (size_t chunk = 0; chunk < count; ++chunk)
                 {
-                    winners.push_back(player.playerName);
+                    out.write(m_chunks[chunk].data(), m_chunks[chunk].size());
+                    addMetric(MetricCounter::BytesRendered, m_chunks[chunk].size());
                 }
             }
+            m_buffer.clear();
+            AppendFooter(m_buffer, GetWinnersString(GetWinners(table)), layout);
+            Flush(out);
+            out.flush();
+        }
 
-            for (const PlayerTable& player : table)
+        ///Row offsets are computed up front, then every chunk is formatted and written
+        ///at its offset independently of other chunks
+        void Build(PositionalFile& file, const PlayersTable& table, ThreadPool& pool)
+        {
+            const TableLayout layout = MakeLayout(table);
+            const size_t chunkCount = (table.size() + RenderChunkSize - 1) / RenderChunkSize;
+            std::vector<uint64_t> offsets(chunkCount + 1, 0);
+            pool.ParallelFor(chunkCount, 1, [&table, &layout, &offsets](size_t begin, size_t end)
             {
-                DrawStringDelimiter(out);
-
-                //1th string
-                out << '|' << std::setfill(' ') << std::setw(maxPlayerNameLen) << std::left << player.playerName;
-                for (size_t i = 0; i < player.frames.size() - 1; ++i)
-                {
-                    const Frame& frame = player.frames[i];
-                    out << '|';
-                    for (size_t i = 0; i < frame.hit.size(); ++ i)
-                    {
-                        out << frame.hit[i];
-                        if (i != frame.hit.size() - 1)
-                            out << ' ';
-                    }
-                    if (frame.hit.size() == 1)  //strike
-                    {
-                        out << "  ";
-                    }
-                }
-                const Frame& tenFrame = player.frames[9];  //10th frame
-                const size_t tenFrameWidth = maxTenFrameHits * 2 - 1;
-                out << '|';
-                for (size_t i = 0; i < tenFrame.hit.size(); ++i)
+                for (size_t chunk = begin; chunk < end; ++chunk)
                 {
-                    out << tenFrame.hit[i];
-                    if (i != tenFrame.hit.size() - 1)
-                        out << ' ';
+                    const size_t last = std::min(table.size(), (chunk + 1) * RenderChunkSize);
+                    for (size_t i = chunk * RenderChunkSize; i < last; ++i)
+                        offsets[chunk + 1] += PlayerRowsSize(table[i], layout);
                 }
-                for (size_t i = 0; i < tenFrameWidth - (tenFrame.hit.size() * 2 - 1); ++i)
-                    out << ' ';
-                out << "|   ";   //len of total is always three
-                out << '|' << std::endl;
-
-                //2th string
-                out << '|';
-                for (size_t i = 0; i < maxPlayerNameLen; ++i)
-                    out << ' ';
-                for (size_t i = 0; i < player.frames.size() - 1; ++i)
+            });
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+                offsets[chunk + 1] += offsets[chunk];
+
+            pool.ParallelFor(chunkCount, 1, [&file, &table, &layout, &offsets](size_t begin, size_t end)
+            {
+                std::string buffer;
+                for (size_t chunk = begin; chunk < end; ++chunk)
                 {
-                    const Frame& frame = player.frames[i];
-                    out << '|';
-                    const size_t frameWidth = std::max(2u, frame.hit.size()) * 2 - 1;
-                    out << std::setfill(' ') << std::setw(frameWidth) << std::left << frame.result;
+                    buffer.clear();
+                    const size_t last = std::min(table.size(), (chunk + 1) * RenderChunkSize);
+                    for (size_t i = chunk * RenderChunkSize; i < last; ++i)
+                        AppendPlayerRows(buffer, table[i], layout);
+                    assert(buffer.size() == offsets[chunk + 1] - offsets[chunk]);
+                    file.WriteAt(offsets[chunk], buffer.data(), buffer.size());
+                    addMetric(MetricCounter::BytesRendered, buffer.size());
                 }
-                out << '|';
-                out << std::setfill(' ') << std::setw(tenFrameWidth) << std::left << tenFrame.result;
-
-                out << '|' << std::setfill(' ') << std::setw(3) << std::left << player.total;
-                out << '|' << std::endl;
-            }
-
-            //hint
-            DrawStringDelimiter(out);
-            out << '|';
-            std::string hint = GetWinnersString(GetWinners(table));
-            const unsigned int indent = (m_tableWidth - 2 - hint.size()) / 2;
-            assert(indent >= 0);
-            for (size_t i = 0; i < indent; ++i)
-                out << ' ';
-            out << hint;
-            for (size_t i = 0; i < (m_tableWidth - 2 - hint.size() - indent); ++i)
-                out << ' ';
-            out << '|' << std::endl;
-
-            DrawStringDelimiter(out);
+            });
+            m_buffer.clear();
+            AppendFooter(m_buffer, GetWinnersString(GetWinners(table)), layout);
+            file.WriteAt(offsets[chunkCount], m_buffer.data(), m_buffer.size());
+            addMetric(MetricCounter::BytesRendered, m_buffer.size());
         }
     };
 
-    class ConsoleRenderer : public Renderer
+    class StreamRenderer : public Renderer
     {
     private:
         WinTableBuilder m_builder;
+        std::ostream& m_out;
+        ThreadPool* const m_pool;
 
     public:
+        StreamRenderer(std::ostream& out, ThreadPool* pool)
+            : m_out(out)
+            , m_pool(pool)
+        {
+        }
+
         void Render(const PlayersTable& table) override
         {
-            m_builder.Build(std::cout, table);
+            if (m_pool != nullptr)
+                m_builder.Build(m_out, table, *m_pool);
+            else
+                m_builder.Build(m_out, table);
         }
     };
 
@@ -194,28 +379,786 @@ namespace //anonymous
     private:
         WinTableBuilder m_builder;
         const std::string m_filename;
+        ThreadPool* const m_pool;
 
     public:
-        FileRenderer(const std::string& filename)
+        FileRenderer(const std::string& filename, ThreadPool* pool)
             : m_filename(filename)
+            , m_pool(pool)
         {
         }
 
         void Render(const PlayersTable& table) override
         {
-            std::ofstream outFile(m_filename, 'w');
+            if (m_pool != nullptr)
+            {
+                PositionalFile outFile(m_filename);
+                m_builder.Build(outFile, table, *m_pool);
+                return;
+            }
+            std::ofstream outFile(m_filename, std::ios::binary | std::ios::trunc);
+            if (!outFile)
+                throw std::runtime_error("Can't open file " + m_filename);
             m_builder.Build(outFile, table);
             outFile.close();
         }
     };
+
+    ///Table with fixed widths, so every player is rendered as soon as it is written: names are cut
+    ///or padded to the configured width and 10th frame always has room for all its hits. Winners
+    ///are tracked along the way for the footer
+    class StreamingTableRenderer : public RecordRenderer
+    {
+    private:
+        const TableLayout m_layout;
+        const std::string m_filename;
+        std::unique_ptr<std::ofstream> m_file;
+        std::ostream& m_out;
+        std::string m_buffer;
+        unsigned int m_maxPlayerResult;
+        std::string m_winners;      ///names of winners joined by " and ", only as long as the hint can show
+        size_t m_winnerCount;
+
+    public:
+        ///Empty filename renders to console
+        StreamingTableRenderer(const std::string& filename, size_t nameWidth)
+            : m_layout(MakeLayout(nameWidth, TenPinFrameHits, MaxHitsPerFrame, true))
+            , m_filename(filename)
+            , m_file(filename.empty() ? nullptr : std::make_unique<std::ofstream>(filename, std::ios::binary | std::ios::trunc))
+            , m_out(m_file ? *m_file : std::cout)
+            , m_maxPlayerResult(0)
+            , m_winnerCount(0)
+        {
+            if (!m_out)
+                throw std::runtime_error("Can't open file " + filename);
+            m_buffer.reserve(FlushSize + 4 * m_layout.tableWidth);
+        }
+
+        void Write(const PlayerTable& player) override
+        {
+            //widths are fixed before the first row, so frames of other rules can't widen them
+            for (size_t i = 0; i < player.frames.size() - 1; ++i)
+            {
+                if (player.frames[i].hit.size() > m_layout.maxFrameHits)
+                    throw std::runtime_error("Frames of player " + player.playerName + " don't fit streaming table");
+            }
+
+            if (player.total > m_maxPlayerResult)
+            {
+                m_maxPlayerResult = player.total;
+                m_winners = player.playerName;
+                m_winnerCount = 1;
+            }
+            else if (player.total == m_maxPlayerResult)
+            {
+                //the hint is cut to the table, so names past its width are never shown
+                if (m_winners.size() <= m_layout.tableWidth)
+                {
+                    if (m_winnerCount != 0)
+                        m_winners += " and ";
+                    m_winners += player.playerName;
+                }
+                ++m_winnerCount;
+            }
+
+            AppendPlayerRows(m_buffer, player, m_layout);
+            if (m_buffer.size() >= FlushSize)
+                Flush();
+        }
+
+        void Flush() override
+        {
+            m_out.write(m_buffer.data(), m_buffer.size());
+            addMetric(MetricCounter::BytesRendered, m_buffer.size());
+            m_buffer.clear();
+            if (!m_out)
+                throw std::runtime_error("Can't write file " + m_filename);
+        }
+
+        void Finish() override
+        {
+            //the table can't widen after rows are out, so long hint is cut to it
+            std::string hint = GetWinnersString(m_winners, m_winnerCount);
+            if (hint.size() > m_layout.tableWidth - 2)
+                hint.resize(m_layout.tableWidth - 2);
+            AppendFooter(m_buffer, hint, m_layout);
+            Flush();
+            m_out.flush();
+        }
+    };
+
+    ///Ranked players one per line: rank, name and total in columns fitting the listed players
+    class LeaderboardRenderer : public Renderer
+    {
+    private:
+        const std::string m_filename;
+        const size_t m_topCount;
+        const RankStyle m_style;
+        ThreadPool& m_pool;
+
+        void Build(std::ostream& out, const PlayersTable& table)
+        {
+            const Ranking ranking = m_topCount == 0
+                ? rankPlayers(table, m_style)
+                : topPlayers(table, m_topCount, m_style, m_pool);
+
+            static const char RankTitle[] = "Rank";
+            static const char PlayerTitle[] = "Player";
+            size_t rankWidth = sizeof(RankTitle) - 1;
+            size_t nameWidth = sizeof(PlayerTitle) - 1;
+            for (const PlayerRank& player : ranking)
+                nameWidth = std::max(nameWidth, table[player.index].playerName.size());
+            if (!ranking.empty())
+                rankWidth = std::max(rankWidth, NumberLength(ranking.back().rank));
+
+            std::string buffer;
+            buffer.reserve(FlushSize + rankWidth + nameWidth + 16);
+            AppendLeft(buffer, RankTitle, sizeof(RankTitle) - 1, rankWidth);
+            buffer += ' ';
+            AppendLeft(buffer, PlayerTitle, sizeof(PlayerTitle) - 1, nameWidth);
+            buffer += " Total\n";
+            for (const PlayerRank& player : ranking)
+            {
+                const PlayerTable& playerTable = table[player.index];
+                AppendNumber(buffer, player.rank, rankWidth);
+                buffer += ' ';
+                AppendLeft(buffer, playerTable.playerName.data(), playerTable.playerName.size(), nameWidth);
+                buffer += ' ';
+                AppendNumber(buffer, playerTable.total, 0);
+                buffer += '\n';
+                if (buffer.size() >= FlushSize)
+                {
+                    out.write(buffer.data(), buffer.size());
+                    addMetric(MetricCounter::BytesRendered, buffer.size());
+                    buffer.clear();
+                }
+            }
+            out.write(buffer.data(), buffer.size());
+            addMetric(MetricCounter::BytesRendered, buffer.size());
+            out.flush();
+        }
+
+    public:
+        ///Empty filename renders to console, topCount 0 lists all players
+        LeaderboardRenderer(const std::string& filename, size_t topCount, RankStyle style, ThreadPool& pool)
+            : m_filename(filename)
+            , m_topCount(topCount)
+            , m_style(style)
+            , m_pool(pool)
+        {
+        }
+
+        void Render(const PlayersTable& table) override
+        {
+            if (m_filename.empty())
+            {
+                Build(std::cout, table);
+                return;
+            }
+            std::ofstream outFile(m_filename, std::ios::binary | std::ios::trunc);
+            if (!outFile)
+                throw std::runtime_error("Can't open file " + m_filename);
+            Build(outFile, table);
+            outFile.close();
+            if (!outFile)
+                throw std::runtime_error("Can't write file " + m_filename);
+        }
+    };
+
+    ///Buffered output file of record renderers
+    class RecordFileRenderer : public RecordRenderer
+    {
+    protected:
+        std::ofstream m_out;
+        std::string m_buffer;
+        const std::string m_filename;
+
+        void FlushIfFull()
+        {
+            if (m_buffer.size() >= FlushSize)
+                Flush();
+        }
+
+    public:
+        explicit RecordFileRenderer(const std::string& filename)
+            : m_out(filename, std::ios::binary | std::ios::trunc)
+            , m_filename(filename)
+        {
+            if (!m_out)
+                throw std::runtime_error("Can't open file " + filename);
+            m_buffer.reserve(FlushSize + 1024);
+        }
+
+        void Flush() override
+        {
+            m_out.write(m_buffer.data(), m_buffer.size());
+            addMetric(MetricCounter::BytesRendered, m_buffer.size());
+            m_buffer.clear();
+            if (!m_out)
+                throw std::runtime_error("Can't write file " + m_filename);
+        }
+
+        void Finish() override
+        {
+            Flush();
+            m_out.flush();
+        }
+    };
+
+    class CsvRenderer : public RecordFileRenderer
+    {
+    private:
+        ///Quote field if it contains separator, quote or line break, quotes are doubled
+        void AppendField(const std::string& field)
+        {
+            if (field.find_first_of(",\"\r\n") == std::string::npos)
+            {
+                m_buffer += field;
+                return;
+            }
+            m_buffer += '"';
+            for (char c : field)
+            {
+                if (c == '"')
+                    m_buffer += '"';
+                m_buffer += c;
+            }
+            m_buffer += '"';
+        }
+
+    public:
+        explicit CsvRenderer(const std::string& filename)
+            : RecordFileRenderer(filename)
+        {
+            m_buffer += "player";
+            for (size_t i = 1; i <= FramesPerGame; ++i)
+            {
+                m_buffer += ",frame";
+                AppendNumber(m_buffer, static_cast<unsigned int>(i), 0);
+                m_buffer += "_hits,frame";
+                AppendNumber(m_buffer, static_cast<unsigned int>(i), 0);
+                m_buffer += "_score";
+            }
+            m_buffer += ",total\n";
+        }
+
+        void Write(const PlayerTable& player) override
+        {
+            AppendField(player.playerName);
+            for (const Frame& frame : player.frames)
+            {
+                m_buffer += ',';
+                m_buffer.append(frame.hit.begin(), frame.hit.end());
+                m_buffer += ',';
+                AppendNumber(m_buffer, frame.result, 0);
+            }
+            m_buffer += ',';
+            AppendNumber(m_buffer, player.total, 0);
+            m_buffer += '\n';
+            FlushIfFull();
+        }
+    };
+
+    class JsonLinesRenderer : public RecordFileRenderer
+    {
+    public:
+        explicit JsonLinesRenderer(const std::string& filename)
+            : RecordFileRenderer(filename)
+        {
+        }
+
+        void Write(const PlayerTable& player) override
+        {
+            appendJsonLine(m_buffer, player);
+            FlushIfFull();
+        }
+    };
+
+    const char BinaryResultMagic[4] = { 'B', 'W', 'L', 'R' };
+    const uint32_t BinaryResultVersion = 1;
+    const size_t BinaryResultCountOffset = 24;
+    const size_t BinaryResultHitsOffset = BinaryResultNameSize;
+    const size_t BinaryResultScoreOffset = BinaryResultHitsOffset + FramesPerGame * MaxHitsPerFrame + 2;
+    const size_t BinaryResultTotalOffset = BinaryResultScoreOffset + 2 * FramesPerGame;
+    static_assert(BinaryResultTotalOffset + 4 == BinaryResultRecordSize, "binary result record layout is broken");
+    static_assert(BinaryResultScoreOffset % 2 == 0 && BinaryResultTotalOffset % 4 == 0, "binary result fields must be aligned");
+
+    void StoreLE(char* out, uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+
+    ///Records are written sequentially, player count in header is patched by Finish
+    class BinaryRenderer : public RecordFileRenderer
+    {
+    private:
+        uint64_t m_playerCount;
+
+    public:
+        explicit BinaryRenderer(const std::string& filename)
+            : RecordFileRenderer(filename)
+            , m_playerCount(0)
+        {
+            char header[BinaryResultHeaderSize] = {};
+            std::copy(BinaryResultMagic, BinaryResultMagic + sizeof(BinaryResultMagic), header);
+            StoreLE(header + 4, BinaryResultVersion, 4);
+            StoreLE(header + 8, BinaryResultRecordSize, 4);
+            StoreLE(header + 12, BinaryResultNameSize, 4);
+            StoreLE(header + 16, FramesPerGame, 4);
+            StoreLE(header + 20, MaxHitsPerFrame, 4);
+            m_buffer.append(header, sizeof(header));
+        }
+
+        void Write(const PlayerTable& player) override
+        {
+            if (player.playerName.size() > BinaryResultNameSize)
+                throw std::runtime_error("Player name " + player.playerName + " is too long for binary record");
+            const size_t start = m_buffer.size();
+            m_buffer.resize(start + BinaryResultRecordSize, '\0');
+            char* record = &m_buffer[start];
+            std::copy(player.playerName.begin(), player.playerName.end(), record);
+            for (size_t i = 0; i < FramesPerGame; ++i)
+            {
+                const Frame& frame = player.frames[i];
+                std::copy(frame.hit.begin(), frame.hit.end(), record + BinaryResultHitsOffset + i * MaxHitsPerFrame);
+                StoreLE(record + BinaryResultScoreOffset + 2 * i, frame.result, 2);
+            }
+            StoreLE(record + BinaryResultTotalOffset, player.total, 4);
+            ++m_playerCount;
+            FlushIfFull();
+        }
+
+        void Finish() override
+        {
+            Flush();
+            char count[8];
+            StoreLE(count, m_playerCount, sizeof(count));
+            m_out.seekp(BinaryResultCountOffset);
+            m_out.write(count, sizeof(count));
+            m_out.seekp(0, std::ios::end);
+            if (!m_out)
+                throw std::runtime_error("Can't write file " + m_filename);
+            m_out.flush();
+        }
+    };
 }   //namespace anonymous
 
 
 RendererPtr getConsoleRenderer()
 {
-    return std::make_unique<ConsoleRenderer>();
+    return std::make_unique<StreamRenderer>(std::cout, nullptr);
 }
 RendererPtr getFileRenderer(const std::string& filename)
 {
-    return std::make_unique<FileRenderer>(filename);
+    return std::make_unique<FileRenderer>(filename, nullptr);
+}
+RendererPtr getStreamRenderer(std::ostream& out)
+{
+    return std::make_unique<StreamRenderer>(out, nullptr);
+}
+
+void appendJsonString(std::string& buffer, const std::string& text)
+{
+    static const char HexDigits[] = "0123456789abcdef";
+    buffer += '"';
+    for (char c : text)
+    {
+        const unsigned char code = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            buffer += '\\';
+            buffer += c;
+        }
+        else if (code < 0x20)
+        {
+            buffer += "\\u00";
+            buffer += HexDigits[code >> 4];
+            buffer += HexDigits[code & 0x0f];
+        }
+        else
+        {
+            buffer += c;
+        }
+    }
+    buffer += '"';
+}
+
+void appendJsonLine(std::string& buffer, const PlayerTable& player)
+{
+    buffer += "{\"player\":";
+    appendJsonString(buffer, player.playerName);
+    buffer += ",\"frames\":[";
+    for (size_t i = 0; i < player.frames.size(); ++i)
+    {
+        const Frame& frame = player.frames[i];
+        if (i != 0)
+            buffer += ',';
+        buffer += "{\"hits\":\"";
+        buffer.append(frame.hit.begin(), frame.hit.end());    //symbols never need escaping
+        buffer += "\",\"score\":";
+        AppendNumber(buffer, frame.result, 0);
+        buffer += '}';
+    }
+    buffer += "],\"total\":";
+    AppendNumber(buffer, player.total, 0);
+    buffer += "}\n";
 }
+
+void RecordRenderer::Render(const PlayersTable& table)
+{
+    for (const PlayerTable& player : table)
+        Write(player);
+    Finish();
+}
+
+RecordRendererPtr getStreamingConsoleRenderer(size_t nameWidth)
+{
+    return std::make_unique<StreamingTableRenderer>(std::string(), nameWidth);
+}
+RecordRendererPtr getStreamingFileRenderer(const std::string& filename, size_t nameWidth)
+{
+    if (filename.empty())
+        throw std::runtime_error("Can't open file with empty name");
+    return std::make_unique<StreamingTableRenderer>(filename, nameWidth);
+}
+
+RendererPtr getLeaderboardConsoleRenderer(size_t topCount, RankStyle style, ThreadPool& pool)
+{
+    return std::make_unique<LeaderboardRenderer>(std::string(), topCount, style, pool);
+}
+RendererPtr getLeaderboardFileRenderer(const std::string& filename, size_t topCount, RankStyle style, ThreadPool& pool)
+{
+    if (filename.empty())
+        throw std::runtime_error("Can't open file with empty name");
+    return std::make_unique<LeaderboardRenderer>(filename, topCount, style, pool);
+}
+
+RecordRendererPtr getCsvRenderer(const std::string& filename)
+{
+    return std::make_unique<CsvRenderer>(filename);
+}
+RecordRendererPtr getJsonLinesRenderer(const std::string& filename)
+{
+    return std::make_unique<JsonLinesRenderer>(filename);
+}
+RecordRendererPtr getBinaryRenderer(const std::string& filename)
+{
+    return std::make_unique<BinaryRenderer>(filename);
+}
+
+RendererPtr getParallelConsoleRenderer(ThreadPool& pool)
+{
+    return std::make_unique<StreamRenderer>(std::cout, &pool);
+}
+RendererPtr getParallelFileRenderer(const std::string& filename, ThreadPool& pool)
+{
+    return std::make_unique<FileRenderer>(filename, &pool);
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include "mapped_file.h"
+#include <sstream>
+
+///File output keeps table layout byte for byte
+TEST(resultRenderer, fileLayout)
+{
+    PlayersTable table(2);
+    table[0].playerName = "Dude";
+    table[1].playerName = "Walter";
+    for (size_t i = 0; i < FramesPerGame; ++i)
+    {
+        table[0].frames[i] = Frame(i + 1, { StrikeSign }, 30);
+        table[1].frames[i] = Frame(i + 1, { '1', MissSign }, 1);
+    }
+    table[0].frames[9] = Frame(10, { StrikeSign, StrikeSign, StrikeSign }, 30);
+    table[0].total = 300;
+    table[1].total = 10;
+
+    const std::string filename = "result_renderer_test.tmp";
+    getFileRenderer(filename)->Render(table);
+    std::ifstream input(filename, std::ios::binary);
+    std::stringstream content;
+    content << input.rdbuf();
+    input.close();
+    std::remove(filename.c_str());
+
+    EXPECT_EQ(content.str(),
+        "------------------------------------------------------\n"
+        "|Dude  |x  |x  |x  |x  |x  |x  |x  |x  |x  |x x x|   |\n"
+        "|      |30 |30 |30 |30 |30 |30 |30 |30 |30 |30   |300|\n"
+        "------------------------------------------------------\n"
+        "|Walter|1 -|1 -|1 -|1 -|1 -|1 -|1 -|1 -|1 -|1 -  |   |\n"
+        "|      |1  |1  |1  |1  |1  |1  |1  |1  |1  |1    |10 |\n"
+        "------------------------------------------------------\n"
+        "|          Dude is winner! Congratulations!          |\n"
+        "------------------------------------------------------\n");
+}
+
+///Hint of tied players wider than the table isn't centered and overflows the frame
+TEST(resultRenderer, tiedHintWiderThanTable)
+{
+    PlayersTable table(4);
+    table[0].playerName = "The Dude";
+    table[1].playerName = "Walter Sobchak";
+    table[2].playerName = "Donny Kerabatsos";
+    table[3].playerName = "Jesus Quintana";
+    for (PlayerTable& player : table)
+    {
+        for (size_t i = 0; i < FramesPerGame; ++i)
+            player.frames[i] = Frame(i + 1, { MissSign, MissSign }, 0);
+    }
+
+    std::stringstream out;
+    getStreamRenderer(out)->Render(table);
+    const std::string content = out.str();
+    const std::string footer =
+        "|The Dude and Walter Sobchak and Donny Kerabatsos and Jesus Quintana are tied!|\n"
+        + std::string(62, '-') + "\n";
+    ASSERT_GE(content.size(), footer.size());
+    EXPECT_EQ(content.substr(content.size() - footer.size()), footer);
+}
+
+///Frames of three-ball rules widen every row together with delimiters and footer
+TEST(resultRenderer, candlepinFrames)
+{
+    PlayersTable table(2);
+    table[0].playerName = "Dude";
+    table[1].playerName = "Walter";
+    for (size_t i = 0; i < FramesPerGame; ++i)
+    {
+        table[0].frames[i] = Frame(i + 1, { '1', '2', '3' }, 6);
+        table[1].frames[i] = Frame(i + 1, { StrikeSign }, 10);
+    }
+    table[0].total = 60;
+    table[1].total = 100;
+
+    std::stringstream out;
+    getStreamRenderer(out)->Render(table);
+    std::string line;
+    std::getline(out, line);
+    EXPECT_EQ(line.size(), 1 + 6 + 6 * (FramesPerGame - 1) + 6 + 4 + 1);
+    const size_t width = line.size();
+    while (std::getline(out, line))
+        EXPECT_EQ(line.size(), width) << line;
+    EXPECT_TRUE(out.eof());
+
+    //streaming table has fixed ten-pin frames
+    RecordRendererPtr streaming = getStreamingConsoleRenderer(6);
+    EXPECT_THROW(streaming->Write(table[0]), std::runtime_error);
+}
+
+namespace //anonymous
+{
+    std::string RenderToString(Renderer& renderer, const std::string& filename, const PlayersTable& table)
+    {
+        renderer.Render(table);
+        std::ifstream input(filename, std::ios::binary);
+        std::stringstream content;
+        content << input.rdbuf();
+        input.close();
+        std::remove(filename.c_str());
+        return content.str();
+    }
+}   //namespace anonymous
+
+///Parallel rendering writes the same bytes as sequential one, rows sizes are predicted exactly
+TEST(resultRenderer, parallelMatchesSequential)
+{
+    PlayersTable table(3 * RenderChunkSize + 17);
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        table[i].playerName = "Player" + std::to_string(i);
+        for (size_t f = 0; f < FramesPerGame; ++f)
+        {
+            const unsigned int result = static_cast<unsigned int>((i * 7 + f * 13) % 31);
+            if ((i + f) % 3 == 0)
+                table[i].frames[f] = Frame(f + 1, { StrikeSign }, result);
+            else
+                table[i].frames[f] = Frame(f + 1, { '7', SpareSign }, result);
+            table[i].total += result;
+        }
+        if (i % 5 == 0)
+            table[i].frames[9] = Frame(10, { StrikeSign, '3', '4' }, 17);
+        else if (i % 5 == 1)
+            table[i].frames[9] = Frame(10, {}, 0);
+    }
+    table[42].playerName = "Player with a long name";
+
+    const TableLayout layout = MakeLayout(table);
+    for (const PlayerTable& player : table)
+    {
+        std::string rows;
+        AppendPlayerRows(rows, player, layout);
+        ASSERT_EQ(rows.size(), PlayerRowsSize(player, layout));
+    }
+
+    const std::string filename = "result_renderer_test.tmp";
+    const std::string sequential = RenderToString(*getFileRenderer(filename), filename, table);
+    ThreadPool pool(4);
+    EXPECT_EQ(RenderToString(*getParallelFileRenderer(filename, pool), filename, table), sequential);
+
+    std::stringstream console;
+    WinTableBuilder builder;
+    builder.Build(console, table, pool);
+    EXPECT_EQ(console.str(), sequential);
+}
+
+namespace //anonymous
+{
+    PlayersTable MakeRecordsTable()
+    {
+        PlayersTable table(2);
+        table[0].playerName = "Dude";
+        table[1].playerName = "Walter, \"Sobchak\"";
+        for (size_t i = 0; i < FramesPerGame; ++i)
+        {
+            table[0].frames[i] = Frame(i + 1, { StrikeSign }, 30);
+            table[1].frames[i] = Frame(i + 1, { '1', MissSign }, 1);
+        }
+        table[0].frames[9] = Frame(10, { StrikeSign, StrikeSign, StrikeSign }, 30);
+        table[0].total = 300;
+        table[1].total = 10;
+        return table;
+    }
+}   //namespace anonymous
+
+TEST(resultRenderer, csvRecords)
+{
+    const std::string filename = "result_renderer_test.tmp";
+    const std::string content = RenderToString(*getCsvRenderer(filename), filename, MakeRecordsTable());
+    EXPECT_EQ(content,
+        "player,frame1_hits,frame1_score,frame2_hits,frame2_score,frame3_hits,frame3_score,frame4_hits,frame4_score,"
+        "frame5_hits,frame5_score,frame6_hits,frame6_score,frame7_hits,frame7_score,frame8_hits,frame8_score,"
+        "frame9_hits,frame9_score,frame10_hits,frame10_score,total\n"
+        "Dude,x,30,x,30,x,30,x,30,x,30,x,30,x,30,x,30,x,30,xxx,30,300\n"
+        "\"Walter, \"\"Sobchak\"\"\",1-,1,1-,1,1-,1,1-,1,1-,1,1-,1,1-,1,1-,1,1-,1,1-,1,10\n");
+}
+
+TEST(resultRenderer, jsonLinesRecords)
+{
+    const std::string filename = "result_renderer_test.tmp";
+    RecordRendererPtr renderer = getJsonLinesRenderer(filename);
+    PlayersTable table = MakeRecordsTable();
+    renderer->Write(table[1]);      //players are written as they come, without table pass
+    table.resize(1);
+    const std::string content = RenderToString(*renderer, filename, table);
+    EXPECT_EQ(content,
+        "{\"player\":\"Walter, \\\"Sobchak\\\"\",\"frames\":[{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1},"
+        "{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1},"
+        "{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1},{\"hits\":\"1-\",\"score\":1}],\"total\":10}\n"
+        "{\"player\":\"Dude\",\"frames\":[{\"hits\":\"x\",\"score\":30},{\"hits\":\"x\",\"score\":30},"
+        "{\"hits\":\"x\",\"score\":30},{\"hits\":\"x\",\"score\":30},{\"hits\":\"x\",\"score\":30},{\"hits\":\"x\",\"score\":30},"
+        "{\"hits\":\"x\",\"score\":30},{\"hits\":\"x\",\"score\":30},{\"hits\":\"x\",\"score\":30},{\"hits\":\"xxx\",\"score\":30}],\"total\":300}\n");
+}
+
+///Records are read straight from mapped file by offset
+TEST(resultRenderer, binaryRecords)
+{
+    const std::string filename = "result_renderer_test.tmp";
+    PlayersTable table = MakeRecordsTable();
+    getBinaryRenderer(filename)->Render(table);
+    {
+        MappedFile file(filename);
+        ASSERT_EQ(file.Size(), BinaryResultHeaderSize + 2 * BinaryResultRecordSize);
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(file.Data());
+        EXPECT_EQ(std::string(file.Data(), 4), "BWLR");
+        EXPECT_EQ(data[24], 2);
+
+        const char* walter = file.Data() + BinaryResultHeaderSize + BinaryResultRecordSize;
+        EXPECT_EQ(std::string(walter), table[1].playerName);
+        EXPECT_EQ(std::string(walter + BinaryResultNameSize, 3), std::string("1-\0", 3));
+        const char* dude = file.Data() + BinaryResultHeaderSize;
+        EXPECT_EQ(std::string(dude + BinaryResultNameSize + 27, 3), "xxx");
+        const unsigned char* dudeScores = data + BinaryResultHeaderSize + 64;
+        EXPECT_EQ(dudeScores[18] | (dudeScores[19] << 8), 30);
+        EXPECT_EQ(dudeScores[20] | (dudeScores[21] << 8), 300);
+    }
+    std::remove(filename.c_str());
+
+    table[0].playerName.assign(BinaryResultNameSize + 1, 'a');
+    EXPECT_THROW(getBinaryRenderer(filename)->Render(table), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
+///With widths that fit the table streaming output is the same as two-pass one
+TEST(resultRenderer, streamingMatchesTable)
+{
+    const std::string filename = "result_renderer_test.tmp";
+    PlayersTable table = MakeRecordsTable();
+    table[1].playerName = "Walter";
+    const std::string expected = RenderToString(*getFileRenderer(filename), filename, table);
+    EXPECT_EQ(RenderToString(*getStreamingFileRenderer(filename, 6), filename, table), expected);
+}
+
+TEST(resultRenderer, streamingTruncatesNames)
+{
+    const std::string filename = "result_renderer_test.tmp";
+    PlayersTable table = MakeRecordsTable();
+    table[0].frames[9] = Frame(10, { '1', MissSign }, 1);
+    table[0].total = 10;
+    EXPECT_EQ(RenderToString(*getStreamingFileRenderer(filename, 4), filename, table),
+        "----------------------------------------------------\n"
+        "|Dude|x  |x  |x  |x  |x  |x  |x  |x  |x  |1 -  |   |\n"
+        "|    |30 |30 |30 |30 |30 |30 |30 |30 |30 |1    |10 |\n"
+        "----------------------------------------------------\n"
+        "|Walt|1 -|1 -|1 -|1 -|1 -|1 -|1 -|1 -|1 -|1 -  |   |\n"
+        "|    |1  |1  |1  |1  |1  |1  |1  |1  |1  |1    |10 |\n"
+        "----------------------------------------------------\n"
+        "|       Dude and Walter, \"Sobchak\" are tied!       |\n"
+        "----------------------------------------------------\n");
+}
+
+///Names of many tied players are cut to the table width
+TEST(resultRenderer, streamingManyTied)
+{
+    PlayersTable table(1000, MakeRecordsTable()[1]);
+    std::string names;
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        table[i].playerName = "P" + std::to_string(i);
+        names += (i == 0 ? "" : " and ") + table[i].playerName;
+    }
+    const std::string filename = "result_renderer_test.tmp";
+    const std::string content = RenderToString(*getStreamingFileRenderer(filename, 4), filename, table);
+    const std::string footer = "|" + names.substr(0, 50) + "|\n" + std::string(52, '-') + "\n";
+    ASSERT_GE(content.size(), footer.size());
+    EXPECT_EQ(content.substr(content.size() - footer.size()), footer);
+}
+
+TEST(resultRenderer, leaderboard)
+{
+    PlayersTable table = MakeRecordsTable();
+    table.resize(4);
+    table[1].playerName = "Walter";
+    table[2].playerName = "Donny";
+    table[2].total = 300;
+    table[3].playerName = "Jesus Quintana";
+    table[3].total = 210;
+
+    const std::string filename = "result_renderer_test.tmp";
+    ThreadPool pool(2);
+    EXPECT_EQ(RenderToString(*getLeaderboardFileRenderer(filename, 0, RankStyle::Competition, pool), filename, table),
+        "Rank Player         Total\n"
+        "1    Dude           300\n"
+        "1    Donny          300\n"
+        "3    Jesus Quintana 210\n"
+        "4    Walter         10\n");
+    EXPECT_EQ(RenderToString(*getLeaderboardFileRenderer(filename, 3, RankStyle::Dense, pool), filename, table),
+        "Rank Player         Total\n"
+        "1    Dude           300\n"
+        "1    Donny          300\n"
+        "2    Jesus Quintana 210\n");
+}
+
+#ifndef _WIN32
+TEST(resultRenderer, leaderboardWriteError)
+{
+    ThreadPool pool(1);
+    EXPECT_THROW(getLeaderboardFileRenderer("/dev/full", 0, RankStyle::Dense, pool)->Render(MakeRecordsTable()), std::runtime_error);
+}
+#endif
+
+#endif
@@ -1,19 +1,83 @@
 #ifndef RESULT_RENDERER_H
 #define RESULT_RENDERER_H
 
+#include "ranking.h"
 #include "types.h"
+#include <iostream>
 #include <memory>
 #include <string>
 
 class Renderer
 {
 public:
+    virtual ~Renderer() {}
     virtual void Render(const PlayersTable& table) = 0;
 };
 
 typedef std::unique_ptr<Renderer> RendererPtr;
 
+///Renderer of formats without table-wide layout, players are written one by one as soon as
+///they are scored. Render writes all players and finishes output
+class RecordRenderer : public Renderer
+{
+public:
+    ///Write record of one player
+    virtual void Write(const PlayerTable& player) = 0;
+    ///Write out buffered records, so text written to the same stream afterwards follows them
+    virtual void Flush() = 0;
+    ///Complete output, must be called after the last player
+    virtual void Finish() = 0;
+
+    void Render(const PlayersTable& table) override;
+};
+
+typedef std::unique_ptr<RecordRenderer> RecordRendererPtr;
+
 RendererPtr getConsoleRenderer();
 RendererPtr getFileRenderer(const std::string& filename);
+///Table into any output stream
+RendererPtr getStreamRenderer(std::ostream& out);
+
+class ThreadPool;
+///Same output, rows are formatted by chunks on pool threads. File chunks are written
+///at precomputed offsets as soon as they are formatted
+RendererPtr getParallelConsoleRenderer(ThreadPool& pool);
+RendererPtr getParallelFileRenderer(const std::string& filename, ThreadPool& pool);
+
+///Table of the same look with fixed widths, players are rendered as soon as they are written:
+///names are cut or padded to nameWidth and 10th frame has room for all its hits. Winners
+///footer is written by Finish
+RecordRendererPtr getStreamingConsoleRenderer(size_t nameWidth);
+RecordRendererPtr getStreamingFileRenderer(const std::string& filename, size_t nameWidth);
+
+///Leaderboard of topCount best players (0 - all players) ranked by total, one line per player:
+///rank, name and total. Top players are found on pool threads without sorting the whole table
+RendererPtr getLeaderboardConsoleRenderer(size_t topCount, RankStyle style, ThreadPool& pool);
+RendererPtr getLeaderboardFileRenderer(const std::string& filename, size_t topCount, RankStyle style, ThreadPool& pool);
+
+///CSV with header line: player,frame1_hits,frame1_score,...,frame10_hits,frame10_score,total.
+///Hits are frame symbols without separators, names are quoted when needed
+RecordRendererPtr getCsvRenderer(const std::string& filename);
+
+///JSON Lines, one object per player:
+///  {"player":"Dude","frames":[{"hits":"x","score":30},...],"total":300}
+RecordRendererPtr getJsonLinesRenderer(const std::string& filename);
+
+///Append text as quoted JSON string
+void appendJsonString(std::string& buffer, const std::string& text);
+///Append JSON Lines record of player, the same as getJsonLinesRenderer() writes
+void appendJsonLine(std::string& buffer, const PlayerTable& player);
+
+///Fixed-width binary records which readers can mmap and index directly, numbers are little-endian:
+///  header:  char magic[4] "BWLR", uint32 version, uint32 record size (88), uint32 name size (32),
+///           uint32 frames per game, uint32 hits per frame, uint64 player count
+///  records: char name[32] (zero padded), char hits[10][3] (zero padded), 2 zero bytes,
+///           uint16 score[10], uint32 total
+///Record of player N starts at 32 + 88 * N. Throws std::runtime_error if name doesn't fit
+RecordRendererPtr getBinaryRenderer(const std::string& filename);
+
+const size_t BinaryResultHeaderSize = 32;
+const size_t BinaryResultRecordSize = 88;
+const size_t BinaryResultNameSize = 32;
 
 #endif //RESULT_RENDERER_H
\ No newline at end of file
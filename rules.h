@@ -0,0 +1,50 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include "const.h"
+#include <cstddef>
+
+//Rules policies: compile-time constants the machine is instantiated with, so every variant
+//gets its own scorer without runtime checks of the variant
+
+///Ten-pin bowling: strike gets two bonus hits, spare gets one
+struct TenPinRules
+{
+    static const size_t FramesPerGame = ::FramesPerGame;
+    static const unsigned int PinsPerFrame = AllPinsDown;
+    static const size_t BallsPerFrame = 2;
+    static const size_t StrikeBonusHits = 2;
+    static const size_t SpareBonusHits = 1;
+    static const char* Name() { return "tenpin"; }
+};
+
+///Candlepin bowling: three balls per frame, pins cleared by the third ball get no bonus
+struct CandlepinRules
+{
+    static const size_t FramesPerGame = 10;
+    static const unsigned int PinsPerFrame = 10;
+    static const size_t BallsPerFrame = 3;
+    static const size_t StrikeBonusHits = 2;
+    static const size_t SpareBonusHits = 1;
+    static const char* Name() { return "candlepin"; }
+};
+
+///Nine-pin bowling scored like ten-pin with nine pins in the rack
+struct NinePinRules
+{
+    static const size_t FramesPerGame = 10;
+    static const unsigned int PinsPerFrame = 9;
+    static const size_t BallsPerFrame = 2;
+    static const size_t StrikeBonusHits = 2;
+    static const size_t SpareBonusHits = 1;
+    static const char* Name() { return "ninepin"; }
+};
+
+///Bonus hits of frame whose pins are all down after ball (1-based) of the frame
+template <class Rules>
+constexpr size_t rulesBonusHits(size_t ball)
+{
+    return ball == 1 ? Rules::StrikeBonusHits : ball == 2 ? Rules::SpareBonusHits : 0;
+}
+
+#endif //RULES_H
@@ -0,0 +1,189 @@
+#include "score_cache.h"
+
+namespace //anonymous
+{
+    const size_t ShardCount = 16;
+
+    ///Memory taken by list and hash map nodes of an entry besides the entry itself
+    const size_t NodeOverhead = 8 * sizeof(void*);
+
+}   //namespace anonymous
+
+ScoreCache::ScoreCache(size_t maxBytes)
+    : m_shards(new Shard[ShardCount])
+    , m_shardMaxBytes(maxBytes / ShardCount)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+{
+    for (size_t i = 0; i < ShardCount; ++i)
+        m_shards[i].bytes = 0;
+}
+
+ScoreCache::~ScoreCache()
+{
+}
+
+uint64_t ScoreCache::Hash(const Hits& hits)
+{
+    //FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int hit : hits)
+    {
+        hash ^= hit;
+        hash *= 1099511628211ull;
+    }
+    return hash ^ hits.size();
+}
+
+size_t ScoreCache::EntryBytes(const Entry& entry)
+{
+    return sizeof(Entry) + entry.hits.capacity() * sizeof(unsigned int) + NodeOverhead;
+}
+
+ScoreCache::Shard& ScoreCache::ShardOf(uint64_t hash)
+{
+    return m_shards[(hash >> 32) % ShardCount];
+}
+
+bool ScoreCache::Find(const Hits& hits, PlayerTable& table)
+{
+    const uint64_t hash = Hash(hits);
+    Shard& shard = ShardOf(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(hash);
+        if (found != shard.index.end() && found->second->hits == hits)
+        {
+            shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+            table.frames = found->second->frames;
+            table.total = found->second->total;
+            ++m_hits;
+            return true;
+        }
+    }
+    ++m_misses;
+    return false;
+}
+
+void ScoreCache::Insert(const Hits& hits, const PlayerTable& table)
+{
+    Entry entry;
+    entry.hash = Hash(hits);
+    entry.hits = hits;
+    entry.frames = table.frames;
+    entry.total = table.total;
+    const size_t bytes = EntryBytes(entry);
+    if (bytes > m_shardMaxBytes)
+        return;
+
+    Shard& shard = ShardOf(entry.hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(entry.hash);
+    if (found != shard.index.end())
+    {
+        //same game inserted by another thread or hash collision, the latest game wins
+        shard.bytes -= EntryBytes(*found->second);
+        shard.entries.erase(found->second);
+        shard.index.erase(found);
+    }
+    while (!shard.entries.empty() && shard.bytes + bytes > m_shardMaxBytes)
+    {
+        const Entry& oldest = shard.entries.back();
+        shard.bytes -= EntryBytes(oldest);
+        shard.index.erase(oldest.hash);
+        shard.entries.pop_back();
+        ++m_evictions;
+    }
+    shard.entries.push_front(std::move(entry));
+    shard.index[shard.entries.front().hash] = shard.entries.begin();
+    shard.bytes += bytes;
+}
+
+ScoreCache::Stats ScoreCache::GetStats() const
+{
+    Stats stats = { m_hits, m_misses, m_evictions, 0, 0 };
+    for (size_t i = 0; i < ShardCount; ++i)
+    {
+        std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+        stats.entries += m_shards[i].entries.size();
+        stats.bytes += m_shards[i].bytes;
+    }
+    return stats;
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+///Cached game is found by equal hits only, the name isn't copied
+TEST(scoreCache, findInserted)
+{
+    ScoreCache cache(1 << 20);
+    PlayerTable table;
+    table.playerName = "Dude";
+    table.frames[0] = Frame(1, { StrikeSign }, 30);
+    table.total = 300;
+    const Hits hits(12, 10);
+
+    PlayerTable found;
+    EXPECT_FALSE(cache.Find(hits, found));
+    cache.Insert(hits, table);
+    EXPECT_TRUE(cache.Find(hits, found));
+    EXPECT_FALSE(cache.Find(Hits(11, 10), found));
+    EXPECT_EQ(found.playerName, "");
+    EXPECT_EQ(found.frames[0], table.frames[0]);
+    EXPECT_EQ(found.total, 300);
+
+    const ScoreCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.entries, 1);
+}
+
+///Memory bound is kept by evicting least recently used games
+TEST(scoreCache, evictsLeastRecentlyUsed)
+{
+    ScoreCache cache(64 * 1024);
+    PlayerTable table;
+    for (unsigned int i = 0; i < 2000; ++i)
+        cache.Insert({ i, i + 1 }, table);
+
+    const ScoreCache::Stats stats = cache.GetStats();
+    EXPECT_LE(stats.bytes, 64u * 1024);
+    EXPECT_GT(stats.evictions, 0);
+    EXPECT_EQ(stats.entries + stats.evictions, 2000);
+    EXPECT_TRUE(cache.Find({ 1999, 2000 }, table));
+    EXPECT_FALSE(cache.Find({ 0, 1 }, table));
+}
+
+///Threads can look up and insert at once
+TEST(scoreCache, sharedBetweenThreads)
+{
+    ScoreCache cache(1 << 20);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&cache, t]()
+        {
+            PlayerTable table;
+            for (unsigned int i = 0; i < 1000; ++i)
+            {
+                table.total = i;
+                if (!cache.Find({ i % 100 }, table))
+                    cache.Insert({ i % 100 }, table);
+                else
+                    EXPECT_EQ(table.total % 100, i % 100);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    const ScoreCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hits + stats.misses, 4000);
+    EXPECT_EQ(stats.entries, 100);
+}
+
+#endif
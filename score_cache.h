@@ -0,0 +1,73 @@
+#ifndef SCORE_CACHE_H
+#define SCORE_CACHE_H
+
+#include "types.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+///Frames and totals of scored games keyed by hash of their hits. Bounded by memory,
+///least recently used games are evicted first. Safe to share between threads
+class ScoreCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t entries;
+        size_t bytes;       ///estimated memory of entries
+    };
+
+    ///maxBytes bounds estimated memory of cached games
+    explicit ScoreCache(size_t maxBytes);
+    ~ScoreCache();
+
+    ScoreCache(const ScoreCache&) = delete;
+    ScoreCache& operator = (const ScoreCache&) = delete;
+
+    ///Copy frames and total of game with these hits into table, player name isn't touched.
+    ///Returns false if the game isn't cached
+    bool Find(const Hits& hits, PlayerTable& table);
+    ///Cache frames and total of table scored from hits
+    void Insert(const Hits& hits, const PlayerTable& table);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry
+    {
+        uint64_t hash;
+        Hits hits;
+        std::array<Frame, FramesPerGame> frames;
+        unsigned int total;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    ///Games are spread by hash between shards, so threads rarely wait for the same lock
+    struct Shard
+    {
+        std::mutex mutex;
+        EntryList entries;      ///most recently used first
+        std::unordered_map<uint64_t, EntryList::iterator> index;
+        size_t bytes;
+    };
+
+    static uint64_t Hash(const Hits& hits);
+    static size_t EntryBytes(const Entry& entry);
+    Shard& ShardOf(uint64_t hash);
+
+    std::unique_ptr<Shard[]> m_shards;
+    size_t m_shardMaxBytes;
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_evictions;
+};
+
+#endif //SCORE_CACHE_H
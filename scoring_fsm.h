@@ -0,0 +1,197 @@
+#ifndef SCORING_FSM_H
+#define SCORING_FSM_H
+
+#include "const.h"
+#include <cstddef>
+#include <utility>
+
+//Scoring as a finite-state machine with transition tables built at compile time from
+//AllPinsDown and FramesPerGame. Functions are single-expression constexpr, so tables and
+//whole games can be checked with static_assert.
+//
+//Machine state is (frame, phase, bonus). Phase is position of the roll inside frame:
+//  0                               first roll
+//  1 + first                       second roll after first pins knocked down
+//  AllPinsDown + 1                 second roll of 10th frame after strike
+//  AllPinsDown + 2                 extra roll of 10th frame with all pins standing
+//  AllPinsDown + 3 + second        extra roll of 10th frame after strike and second pins
+//Bonus is the rolls owed by previous frames, see BonusState.
+
+const size_t RollPhaseCount = 2 * AllPinsDown + 3;
+const size_t PinsCount = AllPinsDown + 1;
+
+///How roll ends the frame
+enum FrameEnd
+{
+    FrameNotOver,
+    FrameOpen,
+    FrameSpare,
+    FrameStrike,
+    FrameEndCount,
+};
+
+///Bonus rolls owed by previous frames to the next roll
+enum BonusState
+{
+    BonusNone,
+    BonusPrevOne,               ///previous frame waits for one roll
+    BonusPrevTwo,               ///previous frame waits for two rolls
+    BonusPrevTwoBeforeOne,      ///previous frame waits for two rolls, the one before it for one
+    BonusStateCount,
+};
+
+struct RollStep
+{
+    unsigned char nextPhase;
+    unsigned char frameEnd;     ///FrameEnd
+    unsigned char frameOver;    ///1 if frameEnd isn't FrameNotOver
+    unsigned char valid;        ///1 if roll isn't more than pins standing
+    char symbol;                ///shown in frame hits the same way getBowlingMachine() does
+};
+
+struct BonusStep
+{
+    unsigned char nextState;
+    unsigned char paysPrev;     ///1 if roll pins are added to previous frame
+    unsigned char paysPrevPrev; ///1 if roll pins are added to the frame before previous
+};
+
+constexpr unsigned int fsmPinsStanding(size_t phase)
+{
+    return phase == 0 || phase == AllPinsDown + 1 || phase == AllPinsDown + 2 ? AllPinsDown
+        : phase <= AllPinsDown ? AllPinsDown - (phase - 1)
+        : AllPinsDown - (phase - (AllPinsDown + 3));
+}
+
+constexpr char fsmPinsChar(size_t pins)
+{
+    return pins == 0 ? MissSign : pins == AllPinsDown ? StrikeSign : static_cast<char>('0' + pins);
+}
+
+constexpr RollStep fsmMakeStep(size_t nextPhase, FrameEnd end, char symbol)
+{
+    return RollStep{ static_cast<unsigned char>(nextPhase), static_cast<unsigned char>(end),
+        static_cast<unsigned char>(end != FrameNotOver), 1, symbol };
+}
+
+constexpr RollStep fsmRegularFrameStep(size_t phase, size_t pins)
+{
+    return phase == 0
+        ? (pins == AllPinsDown ? fsmMakeStep(0, FrameStrike, StrikeSign) : fsmMakeStep(1 + pins, FrameNotOver, fsmPinsChar(pins)))
+        : (phase - 1 + pins == AllPinsDown ? fsmMakeStep(0, FrameSpare, SpareSign) : fsmMakeStep(0, FrameOpen, fsmPinsChar(pins)));
+}
+
+///10th frame owns its extra rolls, so it never owes bonus and ends the game with FrameOpen
+constexpr RollStep fsmLastFrameStep(size_t phase, size_t pins)
+{
+    return phase == 0
+        ? (pins == AllPinsDown ? fsmMakeStep(AllPinsDown + 1, FrameNotOver, StrikeSign) : fsmMakeStep(1 + pins, FrameNotOver, fsmPinsChar(pins)))
+        : phase <= AllPinsDown
+        ? (phase - 1 + pins == AllPinsDown ? fsmMakeStep(AllPinsDown + 2, FrameNotOver, SpareSign) : fsmMakeStep(0, FrameOpen, fsmPinsChar(pins)))
+        : phase == AllPinsDown + 1
+        ? (pins == AllPinsDown ? fsmMakeStep(AllPinsDown + 2, FrameNotOver, StrikeSign) : fsmMakeStep(AllPinsDown + 3 + pins, FrameNotOver, fsmPinsChar(pins)))
+        : fsmMakeStep(0, FrameOpen, fsmPinsChar(pins));
+}
+
+constexpr RollStep fsmRollStep(bool lastFrame, size_t phase, size_t pins)
+{
+    return pins > fsmPinsStanding(phase) || (!lastFrame && phase > AllPinsDown) ? RollStep{ 0, FrameNotOver, 0, 0, 0 }
+        : lastFrame ? fsmLastFrameStep(phase, pins)
+        : fsmRegularFrameStep(phase, pins);
+}
+
+///Owed rolls after the roll is paid: two owed become one, one owed is paid off
+constexpr BonusState fsmBonusPaid(size_t state)
+{
+    return state == BonusPrevTwo || state == BonusPrevTwoBeforeOne ? BonusPrevOne : BonusNone;
+}
+
+///Frame ended by the roll becomes previous one, previous becomes the one before it
+constexpr BonusStep fsmBonusStep(size_t state, size_t end)
+{
+    return BonusStep
+    {
+        static_cast<unsigned char>(
+            end == FrameNotOver ? fsmBonusPaid(state)
+            : end == FrameOpen ? BonusNone
+            : end == FrameSpare ? BonusPrevOne
+            : fsmBonusPaid(state) == BonusNone ? BonusPrevTwo : BonusPrevTwoBeforeOne),
+        static_cast<unsigned char>(state != BonusNone),
+        static_cast<unsigned char>(state == BonusPrevTwoBeforeOne),
+    };
+}
+
+const size_t RollStepCount = 2 * RollPhaseCount * PinsCount;
+const size_t BonusStepCount = BonusStateCount * FrameEndCount;
+
+constexpr size_t fsmRollStepIndex(bool lastFrame, size_t phase, size_t pins)
+{
+    return (static_cast<size_t>(lastFrame) * RollPhaseCount + phase) * PinsCount + pins;
+}
+
+constexpr size_t fsmBonusStepIndex(size_t state, size_t end)
+{
+    return state * FrameEndCount + end;
+}
+
+struct RollTable
+{
+    RollStep steps[RollStepCount];
+};
+
+struct BonusTable
+{
+    BonusStep steps[BonusStepCount];
+};
+
+template <size_t... Index>
+constexpr RollTable fsmMakeRollTable(std::index_sequence<Index...>)
+{
+    return RollTable{ { fsmRollStep(Index / (RollPhaseCount * PinsCount) != 0, Index / PinsCount % RollPhaseCount, Index % PinsCount)... } };
+}
+
+template <size_t... Index>
+constexpr BonusTable fsmMakeBonusTable(std::index_sequence<Index...>)
+{
+    return BonusTable{ { fsmBonusStep(Index / FrameEndCount, Index % FrameEndCount)... } };
+}
+
+constexpr RollTable RollSteps = fsmMakeRollTable(std::make_index_sequence<RollStepCount>());
+constexpr BonusTable BonusSteps = fsmMakeBonusTable(std::make_index_sequence<BonusStepCount>());
+
+///Result of game which is not complete or has wrong rolls
+const unsigned int InvalidScore = ~0u;
+
+constexpr unsigned int fsmScoreRoll(const unsigned int* hits, size_t count, size_t frameIndex, size_t i,
+    size_t frame, const RollStep& step, const BonusStep& bonus, unsigned int score);
+
+///Score of frameIndex frame (FramesPerGame for total) from roll i, running the tables
+constexpr unsigned int fsmScoreFrom(const unsigned int* hits, size_t count, size_t frameIndex, size_t i,
+    size_t frame, size_t phase, size_t bonus, unsigned int score)
+{
+    return i == count ? (frame == FramesPerGame ? score : InvalidScore)
+        : frame == FramesPerGame || hits[i] > AllPinsDown ? InvalidScore
+        : fsmScoreRoll(hits, count, frameIndex, i, frame,
+            RollSteps.steps[fsmRollStepIndex(frame == FramesPerGame - 1, phase, hits[i])],
+            BonusSteps.steps[fsmBonusStepIndex(bonus, RollSteps.steps[fsmRollStepIndex(frame == FramesPerGame - 1, phase, hits[i])].frameEnd)],
+            score);
+}
+
+constexpr unsigned int fsmScoreRoll(const unsigned int* hits, size_t count, size_t frameIndex, size_t i,
+    size_t frame, const RollStep& step, const BonusStep& bonus, unsigned int score)
+{
+    return !step.valid ? InvalidScore
+        : fsmScoreFrom(hits, count, frameIndex, i + 1, frame + step.frameOver, step.nextPhase, bonus.nextState,
+            score + hits[i] * (frameIndex == FramesPerGame
+                ? 1u + bonus.paysPrev + bonus.paysPrevPrev
+                : (frame == frameIndex) + (frame == frameIndex + 1 && bonus.paysPrev) + (frame == frameIndex + 2 && bonus.paysPrevPrev)));
+}
+
+///Total of complete game, or result of frame with frameIndex. InvalidScore for wrong or incomplete game
+template <size_t Count>
+constexpr unsigned int fsmScoreGame(const unsigned int (&hits)[Count], size_t frameIndex = FramesPerGame)
+{
+    return fsmScoreFrom(hits, Count, frameIndex, 0, 0, 0, BonusNone, 0);
+}
+
+#endif //SCORING_FSM_H
@@ -0,0 +1,798 @@
+#include "scoring_server.h"
+#include "metrics.h"
+#include "result_renderer.h"
+#include <stdexcept>
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace //anonymous
+{
+    const size_t ReadChunkSize = 64 * 1024;
+    ///Bytes read from one connection per loop iteration, so one busy client can't starve others
+    const size_t MaxReadPerIteration = 16 * ReadChunkSize;
+    ///Connection isn't read while this many bytes of answers wait for it, so slow reader can't
+    ///grow server memory
+    const size_t MaxPendingOutput = 4 * 1024 * 1024;
+    ///Connection is answered with error and closed when its incomplete line grows over this
+    ///many bytes, so client without line feeds can't grow server memory
+    const size_t MaxPendingInput = 1024 * 1024;
+    const int MaxEvents = 256;
+    ///Line asking for metrics of the server instead of scoring
+    const std::string MetricsRequest = "!metrics";
+
+    void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    sockaddr_un MakeAddress(const std::string& socketPath)
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("Socket path is too long: " + socketPath);
+        std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+        return address;
+    }
+
+    int ConnectTo(const std::string& socketPath)
+    {
+        const sockaddr_un address = MakeAddress(socketPath);
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            ThrowSystemError("Can't create socket");
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            const int error = errno;
+            close(fd);
+            errno = error;
+            ThrowSystemError("Can't connect to " + socketPath);
+        }
+        return fd;
+    }
+
+    ///Remove stale socket left at path by a previous server, any other file is kept
+    void RemoveStaleSocket(const std::string& socketPath)
+    {
+        struct stat status;
+        if (lstat(socketPath.c_str(), &status) != 0)
+        {
+            if (errno == ENOENT)
+                return;
+            ThrowSystemError("Can't check path " + socketPath);
+        }
+        if (!S_ISSOCK(status.st_mode))
+            throw std::runtime_error("Path " + socketPath + " exists and is not a socket");
+        if (unlink(socketPath.c_str()) != 0)
+            ThrowSystemError("Can't remove socket " + socketPath);
+    }
+
+    bool IsBlank(const char* begin, const char* end)
+    {
+        return std::all_of(begin, end, [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+    }
+
+    class ScoringServerImpl : public ScoringServer
+    {
+    private:
+        struct Connection
+        {
+            int fd;
+            std::string input;      ///received bytes not parsed yet
+            size_t linesEnd;        ///input up to here is complete lines
+            std::string output;     ///answers not sent yet
+            uint32_t events;        ///registered in epoll
+            bool readClosed;
+            bool broken;
+            bool ready;             ///has input for the current batch, listed in m_ready
+        };
+
+        ///Answer to one request line: scored player of the batch, error of malformed line or metrics
+        struct Answer
+        {
+            Connection* connection;
+            size_t player;
+            std::string error;
+        };
+
+        static const size_t MalformedLine = ~size_t(0);
+        static const size_t MetricsLine = MalformedLine - 1;
+
+        InputParser& m_parser;
+        BowlingMachine& m_machine;
+        const std::string m_socketPath;
+        int m_listenFd;
+        int m_epollFd;
+        int m_stopFd;
+        struct stat m_socketStatus;     ///of the socket file bound by this server
+        std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+        std::vector<Connection*> m_ready;
+        std::vector<Answer> m_answers;
+        PlayersHits m_batch;
+        PlayersStatus m_statuses;
+
+        void Watch(int fd, uint32_t events, int operation)
+        {
+            epoll_event event = {};
+            event.events = events;
+            event.data.fd = fd;
+            if (epoll_ctl(m_epollFd, operation, fd, &event) != 0)
+                ThrowSystemError("Can't watch socket");
+        }
+
+        void CloseAll()
+        {
+            for (auto& connection : m_connections)
+                close(connection.first);
+            m_connections.clear();
+            for (int fd : { m_listenFd, m_epollFd, m_stopFd })
+            {
+                if (fd >= 0)
+                    close(fd);
+            }
+        }
+
+        void Accept()
+        {
+            for (;;)
+            {
+                const int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED)
+                        continue;
+                    if (errno != EAGAIN && errno != EWOULDBLOCK)
+                        ThrowSystemError("Can't accept connection");
+                    return;
+                }
+                std::unique_ptr<Connection> connection(new Connection{ fd, std::string(), 0, std::string(), EPOLLIN | EPOLLRDHUP, false, false, false });
+                Watch(fd, connection->events, EPOLL_CTL_ADD);
+                m_connections[fd] = std::move(connection);
+            }
+        }
+
+        void Read(Connection& connection)
+        {
+            char buffer[ReadChunkSize];
+            for (size_t total = 0; total < MaxReadPerIteration; )
+            {
+                const ssize_t size = recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (size > 0)
+                {
+                    //only received bytes are searched, so long line isn't scanned again on every read
+                    const void* lineFeed = memrchr(buffer, '\n', size);
+                    if (lineFeed != nullptr)
+                        connection.linesEnd = connection.input.size() + (static_cast<const char*>(lineFeed) - buffer) + 1;
+                    connection.input.append(buffer, size);
+                    total += size;
+                    continue;
+                }
+                if (size == 0)
+                    connection.readClosed = true;
+                else if (errno == EINTR)
+                    continue;
+                else if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    connection.broken = true;
+                break;
+            }
+            if (!connection.ready)
+            {
+                connection.ready = true;
+                m_ready.push_back(&connection);
+            }
+        }
+
+        void Write(Connection& connection)
+        {
+            size_t sent = 0;
+            while (sent != connection.output.size())
+            {
+                const ssize_t size = send(connection.fd, connection.output.data() + sent, connection.output.size() - sent,
+                    MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (size >= 0)
+                {
+                    sent += size;
+                    continue;
+                }
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    connection.broken = true;
+                break;
+            }
+            connection.output.erase(0, sent);
+        }
+
+        ///Send what socket takes, then close finished connection or watch it for what it waits
+        void CompleteIo(Connection& connection)
+        {
+            Write(connection);
+            const bool finished = connection.readClosed && connection.output.empty();
+            if (connection.broken || finished)
+            {
+                close(connection.fd);   //closed descriptor leaves epoll set
+                m_connections.erase(connection.fd);
+                return;
+            }
+            uint32_t events = 0;
+            if (!connection.output.empty())
+                events |= EPOLLOUT;
+            if (!connection.readClosed && connection.output.size() < MaxPendingOutput)
+                events |= EPOLLIN | EPOLLRDHUP;
+            if (events != connection.events)
+            {
+                connection.events = events;
+                Watch(connection.fd, events, EPOLL_CTL_MOD);
+            }
+        }
+
+        ///Parse complete lines of connection into batch, the last line is complete when client
+        ///shut down writing
+        void TakeLines(Connection& connection)
+        {
+            const size_t end = connection.readClosed ? connection.input.size() : connection.linesEnd;
+            const char* data = connection.input.data();
+            addMetric(MetricCounter::BytesParsed, end);
+            for (size_t begin = 0; begin < end; )
+            {
+                const char* lineFeed = static_cast<const char*>(std::memchr(data + begin, '\n', end - begin));
+                const size_t next = lineFeed != nullptr ? lineFeed - data + 1 : end;
+                size_t lineEnd = lineFeed != nullptr ? lineFeed - data : end;
+                if (lineEnd != begin && data[lineEnd - 1] == '\r')
+                    --lineEnd;
+                if (lineEnd - begin == MetricsRequest.size() && MetricsRequest.compare(0, std::string::npos, data + begin, lineEnd - begin) == 0)
+                {
+                    m_answers.push_back(Answer{ &connection, MetricsLine, std::string() });
+                }
+                else if (!IsBlank(data + begin, data + lineEnd))
+                {
+                    addMetric(MetricCounter::LinesParsed, 1);
+                    const size_t player = m_batch.size();
+                    m_batch.emplace_back();
+                    try
+                    {
+                        m_parser.ParseLine(data + begin, data + lineEnd, m_batch.back());
+                        m_answers.push_back(Answer{ &connection, player, std::string() });
+                    }
+                    catch (const std::runtime_error& e)
+                    {
+                        m_batch.pop_back();
+                        m_answers.push_back(Answer{ &connection, MalformedLine, e.what() });
+                        addMetric(MetricCounter::Errors, 1);
+                    }
+                }
+                begin = next;
+            }
+            connection.input.erase(0, end);
+            connection.linesEnd = 0;
+
+            if (connection.input.size() > MaxPendingInput)
+            {
+                m_answers.push_back(Answer{ &connection, MalformedLine,
+                    "Line is longer than " + std::to_string(MaxPendingInput) + " bytes" });
+                addMetric(MetricCounter::Errors, 1);
+                //nothing more is read, connection is closed when the answers are sent
+                connection.input.clear();
+                connection.readClosed = true;
+            }
+        }
+
+        ///Score lines of all ready connections by one machine call and queue answers
+        void ScoreReady()
+        {
+            m_batch.clear();
+            m_answers.clear();
+            {
+                StageTimer timer(MetricStage::Parse);
+                for (Connection* connection : m_ready)
+                    TakeLines(*connection);
+            }
+
+            PlayersTable table;
+            if (!m_batch.empty())
+            {
+                StageTimer timer(MetricStage::Score);
+                table = m_machine.TryCalcPlayersTable(m_batch, m_statuses);
+            }
+            {
+                StageTimer timer(MetricStage::Render);
+                for (const Answer& answer : m_answers)
+                {
+                    std::string& output = answer.connection->output;
+                    const size_t outputSize = output.size();
+                    if (answer.player == MetricsLine)
+                    {
+                        output += "{\"metrics\":";
+                        output += formatMetricsJson(getMetrics());
+                        output += "}\n";
+                    }
+                    else if (answer.player == MalformedLine)
+                    {
+                        output += "{\"error\":";
+                        appendJsonString(output, answer.error);
+                        output += "}\n";
+                    }
+                    else if (m_statuses[answer.player].Ok())
+                    {
+                        appendJsonLine(output, table[answer.player]);
+                    }
+                    else
+                    {
+                        const PlayerStatus& status = m_statuses[answer.player];
+                        output += "{\"player\":";
+                        appendJsonString(output, m_batch[answer.player].playerName);
+                        output += ",\"error\":";
+                        appendJsonString(output, m_machine.ErrorMessage(status.error));
+                        output += ",\"hit\":";
+                        output += std::to_string(status.hitIndex + 1);
+                        output += "}\n";
+                    }
+                    addMetric(MetricCounter::BytesRendered, output.size() - outputSize);
+                }
+            }
+
+            std::vector<Connection*> ready;
+            ready.swap(m_ready);
+            for (Connection* connection : ready)
+            {
+                connection->ready = false;
+                CompleteIo(*connection);
+            }
+        }
+
+    public:
+        ScoringServerImpl(const std::string& socketPath, InputParser& parser, BowlingMachine& machine)
+            : m_parser(parser)
+            , m_machine(machine)
+            , m_socketPath(socketPath)
+            , m_listenFd(-1)
+            , m_epollFd(-1)
+            , m_stopFd(-1)
+            , m_socketStatus()
+        {
+            enableMetrics(true);    //clients may ask for metrics any time
+            try
+            {
+                const sockaddr_un address = MakeAddress(socketPath);
+                RemoveStaleSocket(socketPath);
+                m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (m_listenFd < 0)
+                    ThrowSystemError("Can't create socket");
+                if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+                    ThrowSystemError("Can't bind socket " + socketPath);
+                if (lstat(socketPath.c_str(), &m_socketStatus) != 0)
+                    ThrowSystemError("Can't check socket " + socketPath);
+                if (listen(m_listenFd, SOMAXCONN) != 0)
+                    ThrowSystemError("Can't listen socket " + socketPath);
+                m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+                if (m_epollFd < 0)
+                    ThrowSystemError("Can't create epoll");
+                m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (m_stopFd < 0)
+                    ThrowSystemError("Can't create event");
+                Watch(m_listenFd, EPOLLIN, EPOLL_CTL_ADD);
+                Watch(m_stopFd, EPOLLIN, EPOLL_CTL_ADD);
+            }
+            catch (...)
+            {
+                CloseAll();
+                throw;
+            }
+        }
+
+        ~ScoringServerImpl()
+        {
+            CloseAll();
+            //the path may be taken by another file or server since, then it's left alone
+            struct stat status;
+            if (lstat(m_socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)
+                && status.st_dev == m_socketStatus.st_dev && status.st_ino == m_socketStatus.st_ino)
+                unlink(m_socketPath.c_str());
+        }
+
+        void Run() override
+        {
+            epoll_event events[MaxEvents];
+            for (;;)
+            {
+                const int count = epoll_wait(m_epollFd, events, MaxEvents, -1);
+                if (count < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    ThrowSystemError("Can't wait for events");
+                }
+                for (int i = 0; i < count; ++i)
+                {
+                    const int fd = events[i].data.fd;
+                    if (fd == m_stopFd)
+                    {
+                        uint64_t value = 0;
+                        if (read(m_stopFd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                            ThrowSystemError("Can't read event");
+                        return;
+                    }
+                    if (fd == m_listenFd)
+                    {
+                        Accept();
+                        continue;
+                    }
+                    auto found = m_connections.find(fd);
+                    if (found == m_connections.end())
+                        continue;
+                    Connection& connection = *found->second;
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                        Read(connection);
+                    else if (!connection.ready)
+                        CompleteIo(connection);     //only output is waited for
+                }
+                ScoreReady();
+            }
+        }
+
+        void Stop() override
+        {
+            const uint64_t value = 1;
+            if (write(m_stopFd, &value, sizeof(value)) < 0)
+                ThrowSystemError("Can't stop server");
+        }
+    };
+
+    ///Interleave sending request and receiving answers, so neither side blocks on full socket
+    ///buffers. Returns when answers contain lineCount line feeds
+    void Exchange(int fd, const std::string& request, size_t lineCount, std::string* answers)
+    {
+        size_t sent = 0;
+        size_t received = 0;
+        char buffer[ReadChunkSize];
+        while (received < lineCount)
+        {
+            pollfd poller = { fd, static_cast<short>(POLLIN | (sent < request.size() ? POLLOUT : 0)), 0 };
+            if (poll(&poller, 1, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                ThrowSystemError("Can't poll socket");
+            }
+            if ((poller.revents & POLLOUT) && sent < request.size())
+            {
+                const ssize_t size = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    ThrowSystemError("Can't send request");
+                if (size > 0)
+                    sent += size;
+            }
+            if (poller.revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                const ssize_t size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+                if (size == 0)
+                    throw std::runtime_error("Server closed connection");
+                if (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    ThrowSystemError("Can't receive answers");
+                if (size > 0)
+                {
+                    received += std::count(buffer, buffer + size, '\n');
+                    if (answers != nullptr)
+                        answers->append(buffer, size);
+                }
+            }
+        }
+    }
+
+    size_t CountRequestLines(const std::string& request)
+    {
+        size_t count = 0;
+        for (size_t begin = 0; begin < request.size(); )
+        {
+            size_t end = request.find('\n', begin);
+            if (end == std::string::npos)
+                end = request.size();
+            if (!IsBlank(request.data() + begin, request.data() + end))
+                ++count;
+            begin = end + 1;
+        }
+        return count;
+    }
+
+}   //namespace anonymous
+
+ScoringServerPtr getScoringServer(const std::string& socketPath, InputParser& parser, BowlingMachine& machine)
+{
+    return std::make_unique<ScoringServerImpl>(socketPath, parser, machine);
+}
+
+void runScoringClient(const std::string& socketPath, std::istream& input, std::ostream& output)
+{
+    const int fd = ConnectTo(socketPath);
+    std::exception_ptr sendError;
+    std::thread sender([fd, &input, &sendError]()
+    {
+        try
+        {
+            char buffer[ReadChunkSize];
+            while (input.read(buffer, sizeof(buffer)) || input.gcount() != 0)
+            {
+                const char* data = buffer;
+                size_t size = static_cast<size_t>(input.gcount());
+                while (size != 0)
+                {
+                    const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+                    if (sent < 0 && errno == EINTR)
+                        continue;
+                    if (sent < 0)
+                        ThrowSystemError("Can't send request");
+                    data += sent;
+                    size -= sent;
+                }
+            }
+        }
+        catch (...)
+        {
+            sendError = std::current_exception();
+        }
+        shutdown(fd, SHUT_WR);
+    });
+
+    char buffer[ReadChunkSize];
+    for (;;)
+    {
+        const ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            break;
+        output.write(buffer, size);
+    }
+    sender.join();
+    close(fd);
+    if (sendError)
+        std::rethrow_exception(sendError);
+}
+
+LoadTestStats runScoringLoadTest(const std::string& socketPath, const std::string& request, size_t connections, size_t rounds)
+{
+    const size_t lineCount = CountRequestLines(request);
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<std::exception_ptr> errors(connections);
+    std::vector<std::thread> clients;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < connections; ++i)
+    {
+        clients.emplace_back([&, i]()
+        {
+            try
+            {
+                const int fd = ConnectTo(socketPath);
+                for (size_t round = 0; round < rounds; ++round)
+                {
+                    const auto roundStart = std::chrono::steady_clock::now();
+                    Exchange(fd, request, lineCount, nullptr);
+                    latencies[i].push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - roundStart).count());
+                }
+                close(fd);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& client : clients)
+        client.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const std::exception_ptr& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::vector<double> all;
+    for (const std::vector<double>& connectionLatencies : latencies)
+        all.insert(all.end(), connectionLatencies.begin(), connectionLatencies.end());
+    std::sort(all.begin(), all.end());
+    LoadTestStats stats = {};
+    stats.players = lineCount * rounds * connections;
+    stats.seconds = seconds;
+    stats.medianLatencyMs = all.empty() ? 0 : all[all.size() / 2];
+    stats.maxLatencyMs = all.empty() ? 0 : all.back();
+    return stats;
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+///Answers come in request order for scored, wrong and malformed lines
+TEST(scoringServer, answersClientLines)
+{
+    const std::string socketPath = "scoring_server_test.sock";
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    ScoringServerPtr server = getScoringServer(socketPath, *parser, *machine);
+    std::thread serverThread([&server]() { server->Run(); });
+
+    std::istringstream input(
+        "Dude: 10 10 10 10 10 10 10 10 10 10 10 10\n"
+        "\n"
+        "Walter: 10 10\n"
+        "Donny: 1 x\r\n"
+        "Jesus: 1 0 1 0 1 0 1 0 1 0 1 0 1 0 1 0 1 0 1 0");
+    std::ostringstream output;
+    runScoringClient(socketPath, input, output);
+
+    const PlayersHits players =
+    {
+        { "Dude", Hits(12, 10) },
+        { "Walter", { 10, 10 } },
+        { "Jesus", { 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 } },
+    };
+    PlayersStatus statuses;
+    const PlayersTable expected = machine->TryCalcPlayersTable(players, statuses);
+    ASSERT_FALSE(statuses[1].Ok());
+    std::string expectedOutput;
+    appendJsonLine(expectedOutput, expected[0]);
+    expectedOutput += "{\"player\":\"Walter\",\"error\":\"" + std::string(scoreErrorMessage(statuses[1].error))
+        + "\",\"hit\":" + std::to_string(statuses[1].hitIndex + 1) + "}\n";
+    expectedOutput += "{\"error\":\"Unexpected character in hit values\"}\n";
+    appendJsonLine(expectedOutput, expected[2]);
+    EXPECT_EQ(output.str(), expectedOutput);
+
+    //connections are batched together and every one gets all its answers
+    std::string request;
+    for (size_t i = 0; i < 500; ++i)
+        request += "Player" + std::to_string(i) + ": 10 10 10 10 10 10 10 10 10 10 10 10\n";
+    const LoadTestStats stats = runScoringLoadTest(socketPath, request, 4, 3);
+    EXPECT_EQ(stats.players, 4u * 3u * 500u);
+
+    //metrics are answered in order with the other lines
+    std::istringstream metricsInput("!metrics\nDude: 10 10 10 10 10 10 10 10 10 10 10 10\n");
+    std::ostringstream metricsOutput;
+    runScoringClient(socketPath, metricsInput, metricsOutput);
+    const std::string answers = metricsOutput.str();
+    const std::string metricsPrefix = "{\"metrics\":{\"bytes_parsed\":";
+    EXPECT_EQ(answers.compare(0, metricsPrefix.size(), metricsPrefix), 0);
+    std::string lastAnswer;
+    appendJsonLine(lastAnswer, expected[0]);
+    ASSERT_GE(answers.size(), lastAnswer.size());
+    EXPECT_EQ(answers.substr(answers.size() - lastAnswer.size()), lastAnswer);
+
+    server->Stop();
+    serverThread.join();
+}
+
+///Only stale socket is replaced, other file at the path is kept
+TEST(scoringServer, keepsRegularFile)
+{
+    const std::string path = "scoring_server_test.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "data";
+    }
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    EXPECT_THROW(getScoringServer(path, *parser, *machine), std::runtime_error);
+    std::ifstream file(path, std::ios::binary);
+    std::string content;
+    std::getline(file, content);
+    EXPECT_EQ(content, "data");
+    file.close();
+    std::remove(path.c_str());
+
+    //socket left by the previous server is replaced
+    const std::string socketPath = "scoring_server_test.sock";
+    getScoringServer(socketPath, *parser, *machine).reset();
+    ScoringServerPtr first = getScoringServer(socketPath, *parser, *machine);
+    ScoringServerPtr second = getScoringServer(socketPath, *parser, *machine);
+    first.reset();      //socket of the second server stays
+    struct stat status;
+    ASSERT_EQ(lstat(socketPath.c_str(), &status), 0);
+    EXPECT_TRUE(S_ISSOCK(status.st_mode));
+    second.reset();
+    EXPECT_NE(lstat(socketPath.c_str(), &status), 0);
+}
+
+///Lines split between reads are put together, line without end over the limit closes connection
+TEST(scoringServer, pendingInput)
+{
+    const std::string socketPath = "scoring_server_test.sock";
+    InputParserPtr parser = getMappedInputParser(1);
+    BowlingMachinePtr machine = getBowlingMachine();
+    ScoringServerPtr server = getScoringServer(socketPath, *parser, *machine);
+    std::thread serverThread([&server]() { server->Run(); });
+
+    std::string request;
+    std::string expectedOutput;
+    for (size_t i = 0; request.size() < 4 * ReadChunkSize; ++i)
+    {
+        const std::string name = "Player" + std::to_string(i);
+        request += name + ": 10 10 10 10 10 10 10 10 10 10 10 10\n";
+        appendJsonLine(expectedOutput, machine->CalcPlayersTable({ { name, Hits(12, 10) } })[0]);
+    }
+    std::istringstream input(request);
+    std::ostringstream output;
+    runScoringClient(socketPath, input, output);
+    EXPECT_EQ(output.str(), expectedOutput);
+
+    std::istringstream longInput(std::string(3 * MaxPendingInput, '1'));
+    std::ostringstream longOutput;
+    try
+    {
+        runScoringClient(socketPath, longInput, longOutput);
+    }
+    catch (const std::runtime_error&)
+    {
+        //the rest of the line can't be sent after the server closed connection
+    }
+    EXPECT_EQ(longOutput.str(), "{\"error\":\"Line is longer than " + std::to_string(MaxPendingInput) + " bytes\"}\n");
+
+    server->Stop();
+    serverThread.join();
+}
+
+///Game with hits after the last frame is answered with error, the server goes on serving
+TEST(scoringServer, tooManyHits)
+{
+    const std::string socketPath = "scoring_server_test.sock";
+    InputParserPtr parser = getMappedInputParser(1);
+    ThreadPool pool(2);
+    BowlingMachinePtr machine = getParallelTableBowlingMachine(pool);
+    ScoringServerPtr server = getScoringServer(socketPath, *parser, *machine);
+    std::thread serverThread([&server]() { server->Run(); });
+
+    std::string request = "Many:";
+    for (size_t i = 0; i < 42; ++i)
+        request += " 1";
+    request += "\nDude: 10 10 10 10 10 10 10 10 10 10 10 10\n";
+    for (size_t round = 0; round < 2; ++round)
+    {
+        std::istringstream input(request);
+        std::ostringstream output;
+        runScoringClient(socketPath, input, output);
+        std::string expectedOutput = "{\"player\":\"Many\",\"error\":\"" + scoreErrorMessage(ScoreError::TooManyHits) + "\",\"hit\":21}\n";
+        appendJsonLine(expectedOutput, machine->CalcPlayersTable({ { "Dude", Hits(12, 10) } })[0]);
+        EXPECT_EQ(output.str(), expectedOutput);
+    }
+
+    server->Stop();
+    serverThread.join();
+}
+
+#endif
+
+#else
+
+ScoringServerPtr getScoringServer(const std::string&, InputParser&, BowlingMachine&)
+{
+    throw std::runtime_error("Scoring server is available on Linux only");
+}
+
+void runScoringClient(const std::string&, std::istream&, std::ostream&)
+{
+    throw std::runtime_error("Scoring client is available on Linux only");
+}
+
+LoadTestStats runScoringLoadTest(const std::string&, const std::string&, size_t, size_t)
+{
+    throw std::runtime_error("Scoring load test is available on Linux only");
+}
+
+#endif
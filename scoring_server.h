@@ -0,0 +1,52 @@
+#ifndef SCORING_SERVER_H
+#define SCORING_SERVER_H
+
+#include "bowling_machine.h"
+#include "input_parser.h"
+#include <iostream>
+#include <memory>
+#include <string>
+
+///Long-running scoring service on Unix domain socket. Clients send lines in input file format,
+///every player line is answered by one JSON line, in request order:
+///  {"player":"Dude","frames":[...],"total":300}          - the same as JSON Lines renderer writes
+///  {"player":"Dude","error":"Not enough hits","hit":12}  - wrong player is skipped
+///  {"error":"Unexpected character in hit values"}        - malformed line
+///  {"metrics":{...}}                                    - "!metrics" line, see formatMetricsJson
+///Blank lines get no answer. Connection is closed after client shuts down writing and all its
+///answers are sent
+class ScoringServer
+{
+public:
+    virtual ~ScoringServer() {}
+
+    ///Serve connections until Stop. Lines of all ready connections are parsed by the same parser
+    ///and scored by one machine call
+    virtual void Run() = 0;
+    ///Make Run return, can be called from any thread
+    virtual void Stop() = 0;
+};
+
+typedef std::unique_ptr<ScoringServer> ScoringServerPtr;
+
+///Listen on socketPath, existing socket file is replaced and removed by the destructor if it's
+///still the one created. Event loop is based on epoll, so it is available on Linux only. Throws
+///std::runtime_error if socket can't be created or path has a file which isn't a socket
+ScoringServerPtr getScoringServer(const std::string& socketPath, InputParser& parser, BowlingMachine& machine);
+
+///Send input to server, shut down writing and copy all answers to output
+void runScoringClient(const std::string& socketPath, std::istream& input, std::ostream& output);
+
+struct LoadTestStats
+{
+    size_t players;         ///answered player lines of all connections
+    double seconds;
+    double medianLatencyMs; ///of one round: request sent to last answer received
+    double maxLatencyMs;
+};
+
+///connections clients send request rounds times each, waiting for all answers of a round
+///before the next one
+LoadTestStats runScoringLoadTest(const std::string& socketPath, const std::string& request, size_t connections, size_t rounds);
+
+#endif //SCORING_SERVER_H
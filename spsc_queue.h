@@ -0,0 +1,75 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+///Bounded lock-free queue of one producer thread and one consumer thread. Items are moved
+///through ring buffer, waiting side yields its time slice instead of taking a lock
+template <class T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+        : m_items(capacity + 1)
+        , m_head(0)
+        , m_tail(0)
+        , m_closed(false)
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator = (const SpscQueue&) = delete;
+
+    ///Wait for free place and move item into queue. Returns false if queue is closed
+    bool Push(T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = tail + 1 == m_items.size() ? 0 : tail + 1;
+        while (next == m_head.load(std::memory_order_acquire))
+        {
+            if (m_closed.load(std::memory_order_acquire))
+                return false;
+            std::this_thread::yield();
+        }
+        if (m_closed.load(std::memory_order_acquire))
+            return false;
+        m_items[tail] = std::move(item);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    ///Wait for item and move it out of queue. Returns false if queue is closed and empty
+    bool Pop(T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        while (head == m_tail.load(std::memory_order_acquire))
+        {
+            //items pushed before close are still handed out
+            if (m_closed.load(std::memory_order_acquire) && head == m_tail.load(std::memory_order_acquire))
+                return false;
+            std::this_thread::yield();
+        }
+        item = std::move(m_items[head]);
+        m_head.store(head + 1 == m_items.size() ? 0 : head + 1, std::memory_order_release);
+        return true;
+    }
+
+    ///Producer closes queue after the last item, consumer closes it to stop producer.
+    ///Can be called from both threads
+    void Close()
+    {
+        m_closed.store(true, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> m_items;
+    alignas(64) std::atomic<size_t> m_head;     ///written by consumer only
+    alignas(64) std::atomic<size_t> m_tail;     ///written by producer only
+    std::atomic<bool> m_closed;
+};
+
+#endif //SPSC_QUEUE_H
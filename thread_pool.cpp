@@ -0,0 +1,228 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+struct ThreadPool::Job
+{
+    const RangeTask* task;
+    size_t count;
+    size_t chunkSize;
+    std::atomic<size_t> remaining;  //chunks not finished yet
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+    size_t errorChunk;
+};
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_queued(0)
+    , m_stop(false)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 1; i < threadCount; ++i)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    for (size_t i = 0; i < m_queues.size(); ++i)
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize, const RangeTask& task)
+{
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    if (m_workers.empty() || chunkCount <= 1)
+    {
+        for (size_t begin = 0; begin < count; begin += chunkSize)
+            task(begin, std::min(begin + chunkSize, count));
+        return;
+    }
+
+    Job job;
+    job.task = &task;
+    job.count = count;
+    job.chunkSize = chunkSize;
+    job.remaining = chunkCount;
+    job.errorChunk = chunkCount;
+
+    {
+        //counted before pushing, so a worker can't take a chunk which isn't counted yet
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_queued += chunkCount;
+    }
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        WorkQueue& queue = *m_queues[i % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.push_back({ &job, i });
+    }
+    m_wake.notify_all();
+
+    //calling thread helps instead of blocking, this also makes nested calls from tasks safe
+    Chunk chunk;
+    while (job.remaining > 0 && Steal(0, chunk))
+        Execute(chunk);
+    {
+        //returns only after the worker which finished the last chunk has released the job
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.done.wait(lock, [&job]() { return job.remaining == 0; });
+    }
+
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+bool ThreadPool::Pop(size_t worker, Chunk& chunk)
+{
+    WorkQueue& queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty())
+        return false;
+    chunk = queue.chunks.back();
+    queue.chunks.pop_back();
+    --m_queued;
+    return true;
+}
+
+bool ThreadPool::Steal(size_t first, Chunk& chunk)
+{
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        WorkQueue& queue = *m_queues[(first + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.chunks.empty())
+        {
+            chunk = queue.chunks.front();
+            queue.chunks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Execute(const Chunk& chunk)
+{
+    Job& job = *chunk.job;
+    const size_t begin = chunk.index * job.chunkSize;
+    try
+    {
+        (*job.task)(begin, std::min(begin + job.chunkSize, job.count));
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        if (chunk.index < job.errorChunk)
+        {
+            job.error = std::current_exception();
+            job.errorChunk = chunk.index;
+        }
+    }
+
+    //decremented under the lock: ParallelFor destroys the job as soon as it sees the last chunk done,
+    //so the worker must not touch the job after releasing the lock
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (--job.remaining == 0)
+        job.done.notify_all();
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+    for (;;)
+    {
+        Chunk chunk;
+        if (Pop(index, chunk) || Steal(index + 1, chunk))
+        {
+            Execute(chunk);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [this]() { return m_stop || m_queued > 0; });
+        if (m_stop && m_queued == 0)
+            return;
+    }
+}
+
+#ifdef UNITTEST
+
+#include "gtest/gtest.h"
+#include <stdexcept>
+
+///Every item is processed once, even with chunks of very uneven cost
+TEST(threadPool, parallelForCoversRange)
+{
+    ThreadPool pool(4);
+    std::vector<int> visits(10000, 0);
+    pool.ParallelFor(visits.size(), 7, [&visits](size_t begin, size_t end)
+    {
+        if (begin == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));   //others steal meanwhile
+        for (size_t i = begin; i < end; ++i)
+            ++visits[i];
+    });
+    EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), static_cast<long>(visits.size()));
+}
+
+///The error nearest to the range start is rethrown, like sequential loop would do
+TEST(threadPool, firstErrorRethrown)
+{
+    ThreadPool pool(4);
+    for (int run = 0; run < 20; ++run)
+    {
+        try
+        {
+            pool.ParallelFor(1000, 10, [](size_t begin, size_t)
+            {
+                if (begin == 500)
+                    throw std::runtime_error("early");
+                if (begin == 900)
+                    throw std::runtime_error("late");
+            });
+            FAIL();
+        }
+        catch (const std::runtime_error& e)
+        {
+            EXPECT_STREQ(e.what(), "early");
+        }
+    }
+}
+
+///Jobs finished by workers are released before ParallelFor returns, so short jobs on the stack
+///can follow each other
+TEST(threadPool, shortJobs)
+{
+    ThreadPool pool(4);
+    std::atomic<size_t> sum(0);
+    for (size_t run = 0; run < 2000; ++run)
+    {
+        pool.ParallelFor(4, 1, [&sum](size_t begin, size_t end)
+        {
+            sum += end - begin;
+        });
+    }
+    EXPECT_EQ(sum.load(), 8000u);
+}
+
+///Tasks can start nested loops on the same pool
+TEST(threadPool, nestedParallelFor)
+{
+    ThreadPool pool(3);
+    std::atomic<size_t> sum(0);
+    pool.ParallelFor(8, 1, [&pool, &sum](size_t, size_t)
+    {
+        pool.ParallelFor(100, 10, [&sum](size_t begin, size_t end) { sum += end - begin; });
+    });
+    EXPECT_EQ(sum, 800u);
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///Reusable pool of worker threads with per-worker task queues. Idle workers steal tasks
+///from the other queues, so uneven tasks keep all threads busy
+class ThreadPool
+{
+public:
+    ///Processes [begin, end) range of items
+    typedef std::function<void(size_t begin, size_t end)> RangeTask;
+
+    ///threadCount threads work on every ParallelFor including the calling one (0 - one per core)
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    size_t ThreadCount() const { return m_workers.size() + 1; }
+
+    ///Split [0, count) into ranges of chunkSize items and run task on them in parallel, returns when
+    ///all ranges are done. If tasks throw, rethrows exception of the range nearest to the start,
+    ///so the error is the same as sequential loop would give. Can be called from a task
+    void ParallelFor(size_t count, size_t chunkSize, const RangeTask& task);
+
+private:
+    struct Job;
+
+    struct Chunk
+    {
+        Job* job;
+        size_t index;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    ///Take chunk from the back of worker's own queue
+    bool Pop(size_t worker, Chunk& chunk);
+    ///Take chunk from the front of any queue, scanning them from the first one
+    bool Steal(size_t first, Chunk& chunk);
+    void Execute(const Chunk& chunk);
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_queued;     ///chunks in all queues
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stop;
+};
+
+#endif //THREAD_POOL_H
@@ -1,8 +1,12 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <initializer_list>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "const.h"
@@ -19,6 +23,48 @@ struct PlayerHits
 typedef std::vector<PlayerHits> PlayersHits;
 
 //output types
+
+///Hit symbols of one frame, stored inline so frames don't allocate
+struct FrameHits
+{
+    FrameHits()
+        : count(0)
+    {
+    }
+
+    FrameHits(std::initializer_list<char> i_symbols)
+        : count(0)
+    {
+        for (char symbol : i_symbols)
+            push_back(symbol);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    char operator [] (size_t i) const { return symbols[i]; }
+    const char* begin() const { return symbols.data(); }
+    const char* end() const { return symbols.data() + count; }
+
+    void push_back(char symbol)
+    {
+        assert(count < MaxHitsPerFrame);
+        symbols[count++] = symbol;
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    bool operator == (const FrameHits& other) const
+    {
+        return count == other.count && std::equal(begin(), end(), other.begin());
+    }
+
+    std::array<char, MaxHitsPerFrame> symbols;
+    unsigned char count;
+};
+
 struct Frame
 {
     Frame()
@@ -33,7 +79,7 @@ struct Frame
     {
     }
 
-    Frame(unsigned int i_frameNumber, std::vector<char> i_hit, unsigned int i_result)
+    Frame(unsigned int i_frameNumber, FrameHits i_hit, unsigned int i_result)
         : frameNumber(i_frameNumber)
         , hit(i_hit)
         , result(i_result)
@@ -41,7 +87,7 @@ struct Frame
     }
 
     unsigned int frameNumber;
-    std::vector<char> hit;  ///contains hit information - '1'-'9' for hit, 'x' for strike, '/' for spare and '-' for miss
+    FrameHits hit;          ///contains hit information - '1'-'9' for hit, 'x' for strike, '/' for spare and '-' for miss
     unsigned int result;    ///contains frame result
 
     bool operator == (const Frame& other) const
@@ -53,18 +99,25 @@ struct Frame
     }
 };
 
-struct PlayerTable
+///Table of a game with FrameCount frames. Machines of all rules give PlayerTable, so rules of
+///rules.h must have FramesPerGame frames; rules with other frame count need their own table type
+template <size_t FrameCount>
+struct BasicPlayerTable
 {
-    PlayerTable()
+    BasicPlayerTable()
         : total(0)
     {
     }
 
     std::string playerName;
-    std::array<Frame, FramesPerGame> frames;
+    std::array<Frame, FrameCount> frames;
     unsigned int total;             ///total result for player
 };
 
+typedef BasicPlayerTable<FramesPerGame> PlayerTable;
+
+static_assert(std::is_trivially_copyable<Frame>::value, "frames of player table are copied by value");
+
 typedef std::vector<PlayerTable> PlayersTable;
 
 #endif